@@ -0,0 +1,48 @@
+/*! @file Atmosphere_models.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Atmosphere density models usable as Force_drag_atmosphere policies
+ */
+
+#include "Atmosphere_models.h"
+#include <cstdio>
+#include <fstream>
+
+Tabulated_atmosphere Tabulated_atmosphere::from_file(
+        const std::string &path) {
+    std::vector<double> altitudes, densities;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        double alt, rho;
+        if (line.empty() || line[0] == '#' 
+                || std::sscanf(line.c_str(), "%lf %lf", &alt, &rho) != 2) {
+            continue;
+        }
+        altitudes.push_back(alt);
+        densities.push_back(rho);
+    }
+    return Tabulated_atmosphere(std::move(altitudes), densities);
+}
+
+
+std::optional<Runtime_atmosphere> make_atmosphere(const std::string &name,
+        const std::string &table_file) {
+    if (name == "nrlmsise00") {
+        return Runtime_atmosphere(Nrlmsise00_atmosphere());
+    }
+    if (name == "exponential") {
+        return Runtime_atmosphere(Exponential_atmosphere());
+    }
+    if (name == "ussa76") {
+        return Runtime_atmosphere(Ussa76_atmosphere());
+    }
+    if (name == "tabulated") {
+        Tabulated_atmosphere table = Tabulated_atmosphere::from_file(
+                table_file);
+        if (table.good()) {
+            return Runtime_atmosphere(std::move(table));
+        }
+    }
+    return std::nullopt;
+}
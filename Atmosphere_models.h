@@ -0,0 +1,203 @@
+/*! @file Atmosphere_models.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Atmosphere density models usable as Force_drag_atmosphere policies
+ */
+
+#ifndef ATMOSPHERE_MODELS_H
+#define ATMOSPHERE_MODELS_H
+
+#include "Msis_inputs.h"
+#include "Nrlmsise00_model.h"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Each model provides density(inputs) in kg/m3 and needs_space_weather(), 
+// ...which tells the caller whether epoch and solar/geomagnetic indices 
+// ...must be filled in or only the position is used. Both are inline so 
+// ...that a Force_drag_atmosphere specialised on a model inlines its call.
+
+// NRLMSISE-00, run as the external executable
+class Nrlmsise00_atmosphere {
+public:
+    bool needs_space_weather() const { return true; }
+    double density(const Msis_inputs &inputs) const {
+        return nrlmsise00_run(inputs, nrlmsise00_model_dir());
+    }
+};
+
+// Exponential atmosphere, Vallado (2013) table 8-4
+class Exponential_atmosphere {
+public:
+    bool needs_space_weather() const { return false; }
+    double density(const Msis_inputs &inputs) const {
+        return altitude_density(inputs.alt);
+    }
+
+    static double altitude_density(double alt) {
+        const double *row = layer(alt);
+        return row[1] * std::exp(-(alt - row[0]) / row[2]);
+    }
+
+    static double scale_height(double alt) {
+        return layer(alt)[2];
+    }
+
+    static const double *layer(double alt) {
+        // Base altitude (km), nominal density there (kg/m3), scale height 
+        // ...(km), the layer used is the highest with its base at or below
+        static const double layers[][3] = {
+            {0.0, 1.225, 7.249}, {25.0, 3.899e-2, 6.349}, 
+            {30.0, 1.774e-2, 6.682}, {40.0, 3.972e-3, 7.554}, 
+            {50.0, 1.057e-3, 8.382}, {60.0, 3.206e-4, 7.714}, 
+            {70.0, 8.770e-5, 6.549}, {80.0, 1.905e-5, 5.799}, 
+            {90.0, 3.396e-6, 5.382}, {100.0, 5.297e-7, 5.877}, 
+            {110.0, 9.661e-8, 7.263}, {120.0, 2.438e-8, 9.473}, 
+            {130.0, 8.484e-9, 12.636}, {140.0, 3.845e-9, 16.149}, 
+            {150.0, 2.070e-9, 22.523}, {180.0, 5.464e-10, 29.740}, 
+            {200.0, 2.789e-10, 37.105}, {250.0, 7.248e-11, 45.546}, 
+            {300.0, 2.418e-11, 53.628}, {350.0, 9.518e-12, 53.298}, 
+            {400.0, 3.725e-12, 58.515}, {450.0, 1.585e-12, 60.828}, 
+            {500.0, 6.967e-13, 63.822}, {600.0, 1.454e-13, 71.835}, 
+            {700.0, 3.614e-14, 88.667}, {800.0, 1.170e-14, 124.64}, 
+            {900.0, 5.245e-15, 181.05}, {1000.0, 3.019e-15, 268.00}};
+        int row = 0;
+        while (row + 1 < 28 && layers[row + 1][0] <= alt) {
+            ++row;
+        }
+        return layers[row];
+    }
+};
+
+// U.S. Standard Atmosphere 1976 up to 86 km, from its seven lapse-rate 
+// ...layers in geopotential altitude. Above 86 km the standard integrates 
+// ...species number densities; this model hands over to the exponential 
+// ...atmosphere there, which is within 3% of it at the join.
+class Ussa76_atmosphere {
+public:
+    bool needs_space_weather() const { return false; }
+    double density(const Msis_inputs &inputs) const {
+        return altitude_density(inputs.alt);
+    }
+
+    static double altitude_density(double alt) {
+        if (alt >= 86.0) {
+            return Exponential_atmosphere::altitude_density(alt);
+        }
+        // Base geopotential altitude (km), lapse rate (K/km), base 
+        // ...temperature (K) and base pressure (Pa)
+        static const double layers[7][4] = {
+            {0.0, -6.5, 288.15, 101325.0}, {11.0, 0.0, 216.65, 22632.06}, 
+            {20.0, 1.0, 216.65, 5474.889}, {32.0, 2.8, 228.65, 868.0187}, 
+            {47.0, 0.0, 270.65, 110.9063}, {51.0, -2.8, 270.65, 66.93887}, 
+            {71.0, -2.0, 214.65, 3.956420}};
+        const double earth_radius = 6356.766;   // km
+        const double gmr = 34.163195;            // g0 M0 / R*, K/km
+        const double gas_constant = 287.0531;   // R* / M0, J/(kg K)
+
+        double h = earth_radius * alt / (earth_radius + alt);
+        int layer = 0;
+        while (layer + 1 < 7 && layers[layer + 1][0] <= h) {
+            ++layer;
+        }
+        const double *base = layers[layer];
+        double temperature = base[2] + base[1] * (h - base[0]);
+        double pressure;
+        if (base[1] == 0.0) {
+            pressure = base[3] * std::exp(-gmr * (h - base[0]) / base[2]);
+        }
+        else {
+            pressure = base[3] * std::pow(base[2] / temperature, 
+                    gmr / base[1]);
+        }
+        return pressure / (gas_constant * temperature);
+    }
+};
+
+// Density tabulated against altitude, interpolated linearly in log density 
+// ...and extrapolated with the scale height of the end intervals. The table
+// ...needs at least two strictly ascending altitudes, each with a positive 
+// ...density; otherwise good() is false and density() is NaN.
+class Tabulated_atmosphere {
+public:
+    Tabulated_atmosphere(std::vector<double> in_altitudes, 
+            const std::vector<double> &densities) 
+            : altitudes(std::move(in_altitudes)) {
+        bool valid = altitudes.size() >= 2 
+                && densities.size() == altitudes.size();
+        for (std::size_t i = 0; valid && i < densities.size(); ++i) {
+            valid = densities[i] > 0.0 && std::isfinite(densities[i]) 
+                    && std::isfinite(altitudes[i])
+                    && (i == 0 || altitudes[i] > altitudes[i - 1]);
+        }
+        if (!valid) {
+            altitudes.clear();
+            return;
+        }
+        log_densities.reserve(densities.size());
+        for (double rho : densities) {
+            log_densities.push_back(std::log(rho));
+        }
+    }
+
+    // Table read from a file of altitude (km) and density (kg/m3) pairs, 
+    // ...one per line, with # lines ignored. Not good() if unreadable.
+    static Tabulated_atmosphere from_file(const std::string &path);
+
+    bool good() const { return !altitudes.empty(); }
+
+    bool needs_space_weather() const { return false; }
+    double density(const Msis_inputs &inputs) const {
+        if (altitudes.empty()) {
+            return std::nan("");
+        }
+        std::size_t upper = std::upper_bound(altitudes.begin(), 
+                altitudes.end(), inputs.alt) - altitudes.begin();
+        upper = std::min(std::max<std::size_t>(upper, 1), 
+                altitudes.size() - 1);
+        std::size_t lower = upper - 1;
+        double fraction = (inputs.alt - altitudes[lower]) 
+                / (altitudes[upper] - altitudes[lower]);
+        return std::exp(log_densities[lower] + fraction 
+                * (log_densities[upper] - log_densities[lower]));
+    }
+
+private:
+    std::vector<double> altitudes;
+    std::vector<double> log_densities;
+};
+
+// Model chosen at run time, e.g. from a configuration file
+class Runtime_atmosphere {
+public:
+    using Model = std::variant<Nrlmsise00_atmosphere, Exponential_atmosphere,
+            Ussa76_atmosphere, Tabulated_atmosphere>;
+
+    explicit Runtime_atmosphere(Model in_model) 
+            : model(std::move(in_model)) {}
+
+    bool needs_space_weather() const {
+        return std::visit([](const auto &m) { 
+            return m.needs_space_weather(); }, model);
+    }
+    double density(const Msis_inputs &inputs) const {
+        return std::visit([&inputs](const auto &m) { 
+            return m.density(inputs); }, model);
+    }
+
+private:
+    Model model;
+};
+
+// Model named in configuration: "nrlmsise00", "exponential", "ussa76", or 
+// ..."tabulated" read from table_file. Empty for an unknown name or a table
+// ...that cannot be used.
+std::optional<Runtime_atmosphere> make_atmosphere(const std::string &name,
+        const std::string &table_file = std::string());
+
+#endif
@@ -0,0 +1,61 @@
+/*! @file Density_capture.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Binary log of density model inputs and results for replay
+ */
+
+#include "Density_capture.h"
+#include <cstring>
+
+namespace {
+
+const char capture_magic[8] = {'M', 'S', 'I', 'S', 'C', 'A', 'P', '1'};
+
+}
+
+Density_capture::Density_capture(const std::string &path) {
+    file = std::fopen(path.c_str(), "ab");
+    if (file != NULL && std::ftell(file) == 0) {
+        std::fwrite(capture_magic, sizeof(capture_magic), 1, file);
+    }
+}
+
+
+Density_capture::~Density_capture() {
+    if (file != NULL) {
+        std::fclose(file);
+    }
+}
+
+
+void Density_capture::append(const Msis_inputs &inputs, double rho) {
+    if (file == NULL) {
+        return;
+    }
+    Density_record record;
+    record.inputs = inputs;
+    record.rho = rho;
+    std::lock_guard<std::mutex> lock(file_mutex);
+    std::fwrite(&record, sizeof(record), 1, file);
+}
+
+
+bool read_density_capture(const std::string &path, 
+        std::vector<Density_record> &records) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+    char magic[sizeof(capture_magic)];
+    if (std::fread(magic, sizeof(magic), 1, file) != 1 
+            || std::memcmp(magic, capture_magic, sizeof(magic)) != 0) {
+        std::fclose(file);
+        return false;
+    }
+    Density_record record;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        records.push_back(record);
+    }
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,47 @@
+/*! @file Density_capture.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Binary log of density model inputs and results for replay
+ */
+
+#ifndef DENSITY_CAPTURE_H
+#define DENSITY_CAPTURE_H
+
+#include "Msis_inputs.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One captured evaluation, written to the log as it is laid out in memory
+struct Density_record {
+    Msis_inputs inputs;
+    double rho = 0.0;       // kg/m3
+};
+
+static_assert(sizeof(Density_record) == 2 * sizeof(int) + 8 * sizeof(double),
+        "Density_record must have no padding to be written raw");
+
+// Appends records to a capture log. The log starts with an 8 byte magic 
+// ...followed by native-endian Density_records; appending to an existing 
+// ...log keeps its header. Safe to share between threads.
+class Density_capture {
+public:
+    explicit Density_capture(const std::string &path);
+    ~Density_capture();
+    Density_capture(const Density_capture &) = delete;
+    Density_capture &operator=(const Density_capture &) = delete;
+
+    bool good() const { return file != NULL; }
+    void append(const Msis_inputs &inputs, double rho);
+
+private:
+    std::FILE *file;
+    std::mutex file_mutex;
+};
+
+// Reads a whole capture log, false if it cannot be opened or is not a log
+bool read_density_capture(const std::string &path, 
+        std::vector<Density_record> &records);
+
+#endif
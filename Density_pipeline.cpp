@@ -0,0 +1,106 @@
+/*! @file Density_pipeline.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Density requests passed from integrator threads to batched
+	density workers
+ */
+
+#include "Density_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+Density_pipeline::Density_pipeline(Batch_function in_evaluate,
+        int worker_count, std::size_t in_batch, std::size_t in_ring_capacity)
+        : evaluate(std::move(in_evaluate)),
+        batch(std::max<std::size_t>(in_batch, 1)),
+        ring_capacity(in_ring_capacity) {
+    for (int i = 0; i < std::max(worker_count, 1); ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto &worker : workers) {
+        Worker &target = *worker;
+        worker->thread = std::thread([this, &target]() { run(target); });
+    }
+}
+
+
+Density_pipeline::~Density_pipeline() {
+    // Workers finish what has been submitted before they stop
+    stopping.store(true, std::memory_order_release);
+    for (auto &worker : workers) {
+        worker->thread.join();
+    }
+}
+
+
+Density_channel *Density_pipeline::connect() {
+    std::lock_guard<std::mutex> lock(connect_mutex);
+    Worker &worker = *workers[channels.size() % workers.size()];
+    std::size_t count = worker.channel_count.load(std::memory_order_relaxed);
+    if (count == max_channels) {
+        return nullptr;
+    }
+    channels.push_back(std::make_unique<Density_channel>(ring_capacity));
+    worker.channels[count] = channels.back().get();
+    worker.channel_count.store(count + 1, std::memory_order_release);
+    return channels.back().get();
+}
+
+
+void Density_pipeline::run(Worker &worker) {
+    std::vector<Density_request> requests;
+    std::vector<Msis_inputs> inputs;
+    std::vector<double> rho;
+    requests.reserve(batch);
+    inputs.reserve(batch);
+    int idle = 0;
+    std::size_t start = 0;
+    while (true) {
+        // Stop flag read before draining, so nothing submitted before it
+        // ...was set is left behind
+        bool stop = stopping.load(std::memory_order_acquire);
+        requests.clear();
+        std::size_t count = worker.channel_count.load(
+                std::memory_order_acquire);
+        // Each pass starts one channel on, so a busy first channel cannot
+        // ...fill every batch while the others wait
+        for (std::size_t n = 0; n < count && requests.size() < batch; ++n) {
+            Density_channel &channel = *worker.channels[(start + n) % count];
+            Density_request request;
+            while (requests.size() < batch
+                    && channel.ring.try_pop(request)) {
+                requests.push_back(request);
+            }
+        }
+        start = count > 0 ? (start + 1) % count : 0;
+        if (requests.empty()) {
+            if (stop) {
+                return;
+            }
+            // Spin briefly for latency, then back off so an idle pipeline
+            // ...does not hold a core
+            if (++idle < 64) {
+                std::this_thread::yield();
+            }
+            else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            continue;
+        }
+        idle = 0;
+
+        inputs.clear();
+        for (const Density_request &request : requests) {
+            inputs.push_back(request.inputs);
+        }
+        rho.resize(requests.size());
+        evaluate(inputs.data(), inputs.size(), rho.data());
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            requests[i].completion->complete(rho[i]);
+        }
+        batch_count.fetch_add(1, std::memory_order_relaxed);
+        evaluation_count.fetch_add(requests.size(),
+                std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,155 @@
+/*! @file Density_pipeline.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Density requests passed from integrator threads to batched
+	density workers
+ */
+
+#ifndef DENSITY_PIPELINE_H
+#define DENSITY_PIPELINE_H
+
+#include "Msis_inputs.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded single-producer, single-consumer queue. Each index is written by
+// ...one side only, on its own cache line, and published with release.
+template <typename T>
+class Spsc_ring {
+public:
+    explicit Spsc_ring(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool try_push(const T &value) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        slots[position & mask] = value;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &value) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+// Where a worker leaves the density for one request. Reset by submit, and
+// ...only read once ready.
+class Density_completion {
+public:
+    void reset() { done.store(false, std::memory_order_relaxed); }
+    void complete(double value) {
+        rho = value;
+        done.store(true, std::memory_order_release);
+    }
+    bool ready() const { return done.load(std::memory_order_acquire); }
+    double wait() const {
+        while (!ready()) {
+            std::this_thread::yield();
+        }
+        return rho;
+    }
+
+private:
+    std::atomic<bool> done{false};
+    double rho = 0.0;
+};
+
+struct Density_request {
+    Msis_inputs inputs;
+    Density_completion *completion;
+};
+
+// One integrator thread's queue into the pipeline, used by that thread only
+class Density_channel {
+public:
+    explicit Density_channel(std::size_t capacity) : ring(capacity) {}
+
+    // Queues a request, waiting for space if the workers are behind. The
+    // ...completion must stay put until it is ready.
+    void submit(const Msis_inputs &inputs, Density_completion &completion) {
+        completion.reset();
+        while (!ring.try_push({inputs, &completion})) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    friend class Density_pipeline;
+    Spsc_ring<Density_request> ring;
+};
+
+// Workers each drain the channels assigned to them, up to batch requests
+// ...at a time, through a batch density function, and write each result to
+// ...its request's completion. Integrator threads overlap their own work
+// ...with the evaluation of the densities they have submitted.
+class Density_pipeline {
+public:
+    using Batch_function = std::function<void(const Msis_inputs *,
+            std::size_t, double *)>;
+
+    static constexpr std::size_t max_channels = 64;   // per worker
+
+    explicit Density_pipeline(Batch_function in_evaluate, int worker_count = 2,
+            std::size_t in_batch = 16, std::size_t in_ring_capacity = 256);
+    ~Density_pipeline();
+
+    Density_pipeline(const Density_pipeline &) = delete;
+    Density_pipeline &operator=(const Density_pipeline &) = delete;
+
+    // A channel for the calling integrator thread, spread round the
+    // ...workers. nullptr once every worker has max_channels.
+    Density_channel *connect();
+
+    std::uint64_t batches() const { return batch_count; }
+    std::uint64_t evaluations() const { return evaluation_count; }
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::array<Density_channel *, max_channels> channels;
+        std::atomic<std::size_t> channel_count{0};
+    };
+
+    void run(Worker &worker);
+
+    Batch_function evaluate;
+    std::size_t batch;
+    std::size_t ring_capacity;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex connect_mutex;
+    std::deque<std::unique_ptr<Density_channel>> channels;
+    std::atomic<bool> stopping{false};
+    std::atomic<std::uint64_t> batch_count{0};
+    std::atomic<std::uint64_t> evaluation_count{0};
+};
+
+#endif
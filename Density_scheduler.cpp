@@ -0,0 +1,152 @@
+/*! @file Density_scheduler.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Coroutine propagations awaiting densities from a batching
+	scheduler
+ */
+
+#include "Density_scheduler.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+void Propagation_task::promise_type::Final_awaiter::await_suspend(
+        std::coroutine_handle<promise_type> handle) noexcept {
+    handle.promise().scheduler->finished(handle);
+}
+
+
+void Density_awaiter::await_suspend(std::coroutine_handle<> handle) {
+    scheduler.submit({inputs, &rho, handle});
+}
+
+
+Density_scheduler::Density_scheduler(Batch_function in_evaluate,
+        std::size_t in_batch)
+        : evaluate(std::move(in_evaluate)),
+        batch(std::max<std::size_t>(in_batch, 1)) {}
+
+
+Density_scheduler::~Density_scheduler() {
+    // Propagations never run to the end are freed where they are suspended
+    for (std::coroutine_handle<> handle : ready) {
+        handle.destroy();
+    }
+    for (const Request &request : pending) {
+        request.handle.destroy();
+    }
+}
+
+
+void Density_scheduler::spawn(Propagation_task task) {
+    auto handle = std::exchange(task.handle, nullptr);
+    assert(handle && "spawn() given a moved-from Propagation_task");
+    handle.promise().scheduler = this;
+    std::lock_guard<std::mutex> lock(mutex);
+    ++live;
+    ready.push_back(handle);
+    changed.notify_one();
+}
+
+
+void Density_scheduler::run(int thread_count) {
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; ++i) {
+        threads.emplace_back(&Density_scheduler::work, this);
+    }
+    work();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+
+std::uint64_t Density_scheduler::batches() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return batch_count;
+}
+
+
+std::uint64_t Density_scheduler::evaluations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return evaluation_count;
+}
+
+
+void Density_scheduler::submit(const Request &request) {
+    // Called from await_suspend, on the thread resuming the propagation
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(request);
+    if (pending.size() >= batch) {
+        changed.notify_one();
+    }
+}
+
+
+void Density_scheduler::finished(std::coroutine_handle<> handle) {
+    handle.destroy();
+    std::lock_guard<std::mutex> lock(mutex);
+    --live;
+    if (live == 0) {
+        changed.notify_all();
+    }
+}
+
+
+void Density_scheduler::work() {
+    std::vector<Request> requests;
+    std::vector<Msis_inputs> inputs;
+    std::vector<double> rho;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (!ready.empty()) {
+            std::coroutine_handle<> handle = ready.front();
+            ready.pop_front();
+            ++resuming;
+            lock.unlock();
+            // Runs until it awaits a density or returns; the handle may
+            // ...be resumed elsewhere or freed by the time this returns
+            handle.resume();
+            lock.lock();
+            --resuming;
+            changed.notify_all();
+            continue;
+        }
+        // Wait for the other threads' propagations to suspend too, unless
+        // ...there is already a full batch
+        if (!pending.empty() && (resuming == 0 || pending.size() >= batch)) {
+            // Oldest first, so no propagation waits behind later ones
+            std::size_t count = std::min(batch, pending.size());
+            requests.assign(pending.begin(), pending.begin() + count);
+            pending.erase(pending.begin(), pending.begin() + count);
+            lock.unlock();
+            inputs.clear();
+            for (const Request &request : requests) {
+                inputs.push_back(request.inputs);
+            }
+            rho.resize(count);
+            evaluate(inputs.data(), count, rho.data());
+            for (std::size_t i = 0; i < count; ++i) {
+                *requests[i].rho = rho[i];
+            }
+            lock.lock();
+            for (const Request &request : requests) {
+                ready.push_back(request.handle);
+            }
+            ++batch_count;
+            evaluation_count += count;
+            changed.notify_all();
+            continue;
+        }
+        if (live == 0) {
+            return;
+        }
+        changed.wait(lock);
+    }
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*! @file Density_scheduler.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Coroutine propagations awaiting densities from a batching
+	scheduler
+ */
+
+#ifndef DENSITY_SCHEDULER_H
+#define DENSITY_SCHEDULER_H
+
+// Needs C++20 coroutines, and is empty when built as C++17
+#if defined(__cpp_impl_coroutine)
+
+#include "Msis_inputs.h"
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+class Density_scheduler;
+
+// One propagation, written as a coroutine that co_awaits its densities:
+//
+//     Propagation_task propagate(Density_scheduler &scheduler,
+//             Force_drag_nrlmsise00 &drag, ...) {
+//         for (...) {
+//             // integrator stage up to the drag force
+//             Msis_inputs inputs;
+//             if (drag.begin_acceleration(inputs)) {
+//                 drag.finish_acceleration(
+//                         co_await scheduler.density(inputs));
+//             }
+//         }
+//     }
+//
+// It does not start until given to Density_scheduler::spawn, which then
+// ...owns it and frees it when it returns.
+class Propagation_task {
+public:
+    struct promise_type {
+        Density_scheduler *scheduler = nullptr;
+
+        // Hands the finished coroutine back to the scheduler to free
+        struct Final_awaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle)
+                    noexcept;
+            void await_resume() const noexcept {}
+        };
+
+        Propagation_task get_return_object() {
+            return Propagation_task(
+                    std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        Final_awaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Propagation_task(Propagation_task &&other) noexcept
+            : handle(std::exchange(other.handle, nullptr)) {}
+    Propagation_task(const Propagation_task &) = delete;
+    Propagation_task &operator=(const Propagation_task &) = delete;
+    ~Propagation_task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+private:
+    friend class Density_scheduler;
+    explicit Propagation_task(std::coroutine_handle<promise_type> in_handle)
+            : handle(in_handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Result of Density_scheduler::density, suspending the propagation until
+// ...the batch holding its point has been evaluated
+class Density_awaiter {
+public:
+    Density_awaiter(Density_scheduler &in_scheduler,
+            const Msis_inputs &in_inputs)
+            : scheduler(in_scheduler), inputs(in_inputs) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    double await_resume() const noexcept { return rho; }
+
+private:
+    Density_scheduler &scheduler;
+    Msis_inputs inputs;
+    double rho = 0.0;
+};
+
+// Runs many propagations on a few threads. A propagation runs until it
+// ...awaits a density, then the thread moves on to the next one ready to
+// ...run. Once every runnable propagation has suspended, or batch points
+// ...are waiting, the waiting points are evaluated together through the
+// ...batch function, e.g. nrlmsise00_run_batch, and their propagations
+// ...made ready again.
+class Density_scheduler {
+public:
+    using Batch_function = std::function<void(const Msis_inputs *,
+            std::size_t, double *)>;
+
+    explicit Density_scheduler(Batch_function in_evaluate,
+            std::size_t in_batch = 64);
+    ~Density_scheduler();
+
+    Density_scheduler(const Density_scheduler &) = delete;
+    Density_scheduler &operator=(const Density_scheduler &) = delete;
+
+    void spawn(Propagation_task task);
+
+    // Runs until every spawned propagation has returned, on thread_count
+    // ...threads counting the caller
+    void run(int thread_count = 1);
+
+    Density_awaiter density(const Msis_inputs &inputs) {
+        return Density_awaiter(*this, inputs);
+    }
+
+    std::uint64_t batches() const;
+    std::uint64_t evaluations() const;
+
+private:
+    friend class Density_awaiter;
+    friend struct Propagation_task::promise_type::Final_awaiter;
+
+    struct Request {
+        Msis_inputs inputs;
+        double *rho;
+        std::coroutine_handle<> handle;
+    };
+
+    void submit(const Request &request);
+    void finished(std::coroutine_handle<> handle);
+    void work();
+
+    Batch_function evaluate;
+    std::size_t batch;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::coroutine_handle<>> ready;
+    std::deque<Request> pending;    // oldest first
+    std::size_t live = 0;           // spawned and not yet returned
+    std::size_t resuming = 0;       // threads running a propagation
+    std::uint64_t batch_count = 0;
+    std::uint64_t evaluation_count = 0;
+};
+
+#endif
+
+#endif
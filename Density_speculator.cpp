@@ -0,0 +1,179 @@
+/*! @file Density_speculator.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Look-ahead density evaluation on a helper thread
+ */
+
+#include "Density_speculator.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+Density_speculator::Density_speculator(
+        std::function<double(const Msis_inputs &)> in_density, int in_depth,
+        double in_tolerance)
+        : density(std::move(in_density)), depth(std::max(in_depth, 1)),
+        tolerance(in_tolerance) {
+    helper = std::thread(&Density_speculator::run, this);
+}
+
+
+Density_speculator::~Density_speculator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_one();
+    helper.join();
+}
+
+
+double Density_speculator::take(const Msis_inputs &inputs,
+        double scale_height) {
+    // Whether a guess hits depends only on the points observed, never on
+    // ...how far the helper has got, so a run gives the same densities
+    // ...however the threads are scheduled
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto it = guesses.begin(); it != guesses.end(); ++it) {
+        if (it->state == Guess_state::stale || !near(it->inputs, inputs)) {
+            continue;
+        }
+        if (it->state == Guess_state::queued) {
+            // Not started: evaluated here, the same as the helper would,
+            // ...rather than waiting behind the guesses queued before it
+            it->state = Guess_state::running;
+            Msis_inputs guess_inputs = it->inputs;
+            lock.unlock();
+            double rho = density(guess_inputs);
+            lock.lock();
+            it->rho = rho;
+            it->state = Guess_state::ready;
+        }
+        done.wait(lock, [&]() { return it->state == Guess_state::ready; });
+        double rho = scale_height > 0.0 ? it->rho * std::exp(
+                -(inputs.alt - it->inputs.alt) / scale_height) : it->rho;
+        hit_period = it->period;
+        guesses.erase(it);
+        ++count.hits;
+        return rho;
+    }
+    ++count.misses;
+    return std::nan("");
+}
+
+
+void Density_speculator::observe(const Msis_inputs &inputs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    history.push_back(inputs);
+    while (static_cast<int>(history.size()) > depth + 1) {
+        history.pop_front();
+    }
+
+    // Guesses for this point are done with; one being evaluated is left
+    // ...for the helper to drop
+    for (auto it = guesses.begin(); it != guesses.end();) {
+        if (it->state == Guess_state::running) {
+            it->state = Guess_state::stale;
+        }
+        if (it->state == Guess_state::stale) {
+            ++it;
+        }
+        else {
+            it = guesses.erase(it);
+        }
+    }
+
+    // The latest point plus the step that followed it period evaluations
+    // ...back, the period that hit last first
+    int last = static_cast<int>(history.size()) - 1;
+    std::vector<int> periods = {hit_period};
+    for (int period = 1; period <= depth; ++period) {
+        if (period != hit_period) {
+            periods.push_back(period);
+        }
+    }
+    for (int period : periods) {
+        if (last - period < 0) {
+            continue;
+        }
+        const Msis_inputs &from = history[last - period];
+        const Msis_inputs &to = history[last - period + 1];
+        Guess guess;
+        guess.inputs = inputs;
+        guess.period = period;
+        guess.inputs.second += to.second - from.second;
+        guess.inputs.alt += to.alt - from.alt;
+        guess.inputs.lat += to.lat - from.lat;
+        guess.inputs.lon = std::remainder(guess.inputs.lon
+                + std::remainder(to.lon - from.lon, 360.0), 360.0);
+        if (guess.inputs.second < 0.0 || guess.inputs.second >= 86400.0
+                || std::fabs(guess.inputs.lat) > 90.0) {
+            continue;
+        }
+        bool repeated = false;
+        for (const Guess &other : guesses) {
+            repeated = repeated || (other.state != Guess_state::stale
+                    && near(other.inputs, guess.inputs));
+        }
+        if (!repeated) {
+            guesses.push_back(guess);
+        }
+    }
+    work.notify_one();
+}
+
+
+Drag_speculation_counts Density_speculator::counts() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+
+bool Density_speculator::near(const Msis_inputs &a,
+        const Msis_inputs &b) const {
+    // Same model second, and within tolerance in altitude and along the
+    // ...ground
+    if (a.second != b.second || a.day_of_year != b.day_of_year
+            || a.year != b.year) {
+        return false;
+    }
+    const double km_per_degree = 111.2;
+    double north = (a.lat - b.lat) * km_per_degree;
+    double east = std::remainder(a.lon - b.lon, 360.0) * km_per_degree
+            * std::cos(a.lat * M_PI / 180.0);
+    return std::fabs(a.alt - b.alt) <= tolerance
+            && north * north + east * east <= tolerance * tolerance;
+}
+
+
+void Density_speculator::run() {
+    // Evaluates queued guesses in order, outside the lock
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto next = guesses.end();
+        work.wait(lock, [&]() {
+            next = std::find_if(guesses.begin(), guesses.end(),
+                    [](const Guess &guess) {
+                        return guess.state == Guess_state::queued; });
+            return stopping || next != guesses.end();
+        });
+        if (stopping) {
+            return;
+        }
+        next->state = Guess_state::running;
+        Msis_inputs inputs = next->inputs;
+        lock.unlock();
+        double rho = density(inputs);
+        lock.lock();
+        ++count.evaluations;
+        if (next->state == Guess_state::stale) {
+            guesses.erase(next);
+        }
+        else {
+            next->rho = rho;
+            next->state = Guess_state::ready;
+        }
+        done.notify_all();
+    }
+}
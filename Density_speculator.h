@@ -0,0 +1,76 @@
+/*! @file Density_speculator.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Look-ahead density evaluation on a helper thread
+ */
+
+#ifndef DENSITY_SPECULATOR_H
+#define DENSITY_SPECULATOR_H
+
+#include "Force_drag_stats.h"
+#include "Msis_inputs.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+// Guesses where the next density evaluation will be and runs the model
+// ...there on a helper thread while the integrator works. Integrator
+// ...stages repeat with a period (four for RK4), so the guesses are the
+// ...latest point moved on by the step that followed it one, two, up to
+// ...depth evaluations back, with the period that last hit tried first.
+// ...A guess hits when it is at the same model second and within
+// ...tolerance km of the point asked for; the difference in altitude is
+// ...corrected for with the scale height. A hit is therefore not bitwise
+// ...equal to a direct evaluation at the point, only close to it. Hits
+// ...depend only on the points observed, so they are the same in every
+// ...run, but the helper's progress only changes how long take() waits.
+class Density_speculator {
+public:
+    Density_speculator(std::function<double(const Msis_inputs &)> in_density,
+            int in_depth = 4, double in_tolerance = 1.0);
+    ~Density_speculator();
+
+    Density_speculator(const Density_speculator &) = delete;
+    Density_speculator &operator=(const Density_speculator &) = delete;
+
+    // Density from a guess near inputs, waiting for it if the helper is
+    // ...part way through evaluating it and evaluating it here if the
+    // ...helper has not started it. NaN when no guess was close.
+    double take(const Msis_inputs &inputs, double scale_height);
+
+    // Point just evaluated, from which the next guesses are made
+    void observe(const Msis_inputs &inputs);
+
+    Drag_speculation_counts counts() const;
+
+private:
+    enum class Guess_state { queued, running, ready, stale };
+
+    struct Guess {
+        Msis_inputs inputs;
+        int period;
+        double rho = 0.0;
+        Guess_state state = Guess_state::queued;
+    };
+
+    bool near(const Msis_inputs &a, const Msis_inputs &b) const;
+    void run();
+
+    std::function<double(const Msis_inputs &)> density;
+    int depth;
+    double tolerance;
+    mutable std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable done;
+    std::deque<Msis_inputs> history;
+    std::list<Guess> guesses;
+    int hit_period = 1;
+    bool stopping = false;
+    Drag_speculation_counts count;
+    std::thread helper;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*! @file Density_tile_cache.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Memory-bounded cache of density tiles in time, altitude, latitude
+	and local time
+ */
+
+#include "Density_tile_cache.h"
+
+Density_tile_cache::Density_tile_cache(std::size_t in_byte_limit,
+        std::size_t in_shard_count)
+        : limit(in_byte_limit),
+        shard_count(std::max<std::size_t>(in_shard_count, 1)) {
+    shard_limit = limit / shard_count;
+    shards.reset(new Shard[shard_count]);
+}
+
+
+std::size_t Density_tile_cache::tile_bytes(const Density_tile &tile) {
+    // Node values plus the slot, index entry and shared_ptr control block
+    return tile.capacity() * sizeof(double) + sizeof(Slot)
+            + sizeof(Density_tile_key) + 64;
+}
+
+
+Density_tile_cache::Tile_ptr Density_tile_cache::find_or_build(
+        const Density_tile_key &key,
+        const std::function<Density_tile()> &build) {
+    Shard &shard = shards[Density_tile_key_hash()(key) % shard_count];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot &slot = shard.slots[it->second];
+            slot.referenced = true;
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return slot.tile;
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    Tile_ptr tile = std::make_shared<const Density_tile>(build());
+    std::size_t bytes = tile_bytes(*tile);
+    if (bytes > shard_limit) {
+        // Larger than the shard's whole budget, handed back uncached
+        return tile;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        return shard.slots[it->second].tile;
+    }
+    make_room(shard, bytes);
+    std::size_t position;
+    if (!shard.free_slots.empty()) {
+        position = shard.free_slots.back();
+        shard.free_slots.pop_back();
+    }
+    else {
+        position = shard.slots.size();
+        shard.slots.emplace_back();
+    }
+    // Starts clear, so a tile used once is the first to go
+    shard.slots[position] = {key, tile, bytes, false};
+    shard.index.emplace(key, position);
+    shard.bytes += bytes;
+    return tile;
+}
+
+
+void Density_tile_cache::make_room(Shard &shard, std::size_t bytes) {
+    // CLOCK sweep, at most two turns: the first may only clear bits
+    while (shard.bytes + bytes > shard_limit && !shard.index.empty()) {
+        for (std::size_t step = 0; step < 2 * shard.slots.size(); ++step) {
+            Slot &slot = shard.slots[shard.hand];
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+            if (slot.tile == nullptr) {
+                continue;
+            }
+            if (slot.referenced) {
+                slot.referenced = false;
+                continue;
+            }
+            shard.index.erase(slot.key);
+            shard.bytes -= slot.bytes;
+            shard.free_slots.push_back(&slot - shard.slots.data());
+            slot = Slot();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+
+Density_tile_cache_stats Density_tile_cache::stats() const {
+    Density_tile_cache_stats result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.evictions = evictions.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        result.bytes += shards[i].bytes;
+        result.tiles += shards[i].index.size();
+    }
+    return result;
+}
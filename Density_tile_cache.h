@@ -0,0 +1,140 @@
+/*! @file Density_tile_cache.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Memory-bounded cache of density tiles in time, altitude, latitude
+	and local time
+ */
+
+#ifndef DENSITY_TILE_CACHE_H
+#define DENSITY_TILE_CACHE_H
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Log density at the nodes of a tile, in (alt, lat, local time) order
+using Density_tile = std::vector<double>;
+
+struct Density_tile_key {
+    std::int64_t epoch_bucket;
+    int alt_band;
+    int lat_band;
+    int local_time_band;
+
+    bool operator==(const Density_tile_key &other) const {
+        return epoch_bucket == other.epoch_bucket
+                && alt_band == other.alt_band && lat_band == other.lat_band
+                && local_time_band == other.local_time_band;
+    }
+};
+
+struct Density_tile_key_hash {
+    std::size_t operator()(const Density_tile_key &key) const {
+        std::uint64_t h = static_cast<std::uint64_t>(key.epoch_bucket);
+        h = h * 0x9e3779b97f4a7c15ull + static_cast<std::uint32_t>(
+                key.alt_band);
+        h = h * 0x9e3779b97f4a7c15ull + static_cast<std::uint32_t>(
+                key.lat_band);
+        h = h * 0x9e3779b97f4a7c15ull + static_cast<std::uint32_t>(
+                key.local_time_band);
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+};
+
+struct Density_tile_cache_stats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t bytes = 0;          // held by the cache now
+    std::size_t tiles = 0;
+};
+
+// Tiles shared between threads under a byte limit. Keys are spread over
+// ...shards, each with its own lock, byte budget and CLOCK hand, so lookups
+// ...on different shards never contend and there is no global lock. A hit
+// ...sets the tile's reference bit; to make room the hand sweeps the shard,
+// ...clearing set bits and evicting the first tile found clear. Evicted
+// ...tiles stay alive for threads still interpolating from them, only the
+// ...cache's share of the memory is bounded.
+class Density_tile_cache {
+public:
+    using Tile_ptr = std::shared_ptr<const Density_tile>;
+
+    explicit Density_tile_cache(std::size_t in_byte_limit,
+            std::size_t shard_count = 16);
+
+    // Tile for key, made by build on a miss. build runs outside the shard
+    // ...lock; two threads missing on the same key may both build it, and
+    // ...the first to finish is kept.
+    Tile_ptr find_or_build(const Density_tile_key &key,
+            const std::function<Density_tile()> &build);
+
+    Density_tile_cache_stats stats() const;
+    std::size_t byte_limit() const { return limit; }
+
+private:
+    struct Slot {
+        Density_tile_key key;
+        Tile_ptr tile;
+        std::size_t bytes = 0;
+        bool referenced = false;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Density_tile_key, std::size_t,
+                Density_tile_key_hash> index;
+        std::vector<Slot> slots;            // CLOCK ring
+        std::vector<std::size_t> free_slots;
+        std::size_t hand = 0;
+        std::size_t bytes = 0;
+    };
+
+    static std::size_t tile_bytes(const Density_tile &tile);
+    void make_room(Shard &shard, std::size_t bytes);
+
+    std::size_t limit;
+    std::size_t shard_limit;
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shard_count;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+};
+
+// Trilinear interpolation in log density within one cell of a tile of
+// ...edge nodes a side, node pointing at the cell's lowest corner, fa, fb
+// ...and fc how far across the cell along each axis
+inline double tile_interpolate(const double *node, int edge, double fa,
+        double fb, double fc) {
+    auto line = [fc](const double *p) {
+        return p[0] + fc * (p[1] - p[0]);
+    };
+    auto plane = [&line, edge, fb](const double *p) {
+        double low = line(p);
+        return low + fb * (line(p + edge) - low);
+    };
+    double low = plane(node);
+    return std::exp(low + fa * (plane(node + edge * edge) - low));
+}
+
+// Grid of a Tiled_atmosphere. Epoch buckets divide each day, and within
+// ...one the atmosphere is taken as fixed in local time, i.e. turning with
+// ...the Sun, at the date, indices and time of the bucket centre.
+struct Density_tile_grid {
+    double bucket_seconds = 3600.0;
+    double alt_min = 100.0;         // km
+    double alt_max = 1000.0;        // km
+    double alt_step = 5.0;          // km
+    double lat_step = 5.0;          // deg
+    double local_time_step = 0.5;   // hours
+    int tile_cells = 4;             // grid cells along each edge of a tile
+};
+
+#endif
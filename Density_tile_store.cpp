@@ -0,0 +1,294 @@
+/*! @file Density_tile_store.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Density tiles kept on disk between runs, keyed by model and space
+	weather
+ */
+
+#include "Density_tile_store.h"
+#include "Drag_log.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char store_magic[8] = {'M', 'S', 'I', 'S', 'T', 'I', 'L', '1'};
+
+// Bucket file: magic, tile and node counts and the bucket hash, one
+// ...present byte per tile padded to 8, then the node values of each tile
+struct Store_header {
+    char magic[8];
+    std::uint32_t tile_count;
+    std::uint32_t node_count;
+    std::uint64_t hash;
+};
+
+// FNV-1a, for naming files by their contents' inputs
+struct Store_hash {
+    std::uint64_t value = 0xcbf29ce484222325ull;
+
+    void add(const void *data, std::size_t size) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            value = (value ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+    template <typename T> void add(const T &field) {
+        add(&field, sizeof(field));
+    }
+};
+
+std::size_t present_bytes(std::uint32_t tile_count) {
+    return (tile_count + 7) & ~std::size_t(7);
+}
+
+int grid_tiles(double cells, int tile_cells) {
+    int count = static_cast<int>(std::ceil(cells));
+    return (count + tile_cells - 1) / tile_cells;
+}
+
+}
+
+Density_tile_store::Density_tile_store(const std::string &in_directory,
+        const std::string &in_model_version,
+        const std::vector<std::string> &index_files,
+        std::size_t in_max_mappings)
+        : directory(in_directory), model_version(in_model_version),
+        max_mappings(std::max<std::size_t>(in_max_mappings, 1)) {
+    // Fingerprint of the index files, compared with the one the directory
+    // ...was last used with
+    Store_hash hash;
+    for (const std::string &path : index_files) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            Drag_log::instance().write(Drag_log_id::index_file_missing,
+                    "Density_tile_store: Unable to open %s", path.c_str());
+            continue;
+        }
+        char buffer[65536];
+        std::size_t size;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            hash.add(buffer, size);
+        }
+        std::fclose(file);
+    }
+    index_hash = hash.value;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string manifest = directory + "/manifest";
+    std::uint64_t previous = 0;
+    if (std::FILE *file = std::fopen(manifest.c_str(), "rb")) {
+        if (std::fread(&previous, sizeof(previous), 1, file) != 1) {
+            previous = 0;
+        }
+        std::fclose(file);
+    }
+    if (previous != index_hash) {
+        for (const auto &entry
+                : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.path().extension() == ".tiles") {
+                std::filesystem::remove(entry.path(), error);
+            }
+        }
+        if (std::FILE *file = std::fopen(manifest.c_str(), "wb")) {
+            usable = std::fwrite(&index_hash, sizeof(index_hash), 1,
+                    file) == 1;
+            std::fclose(file);
+        }
+    }
+    else {
+        usable = true;
+    }
+}
+
+
+Density_tile_store::~Density_tile_store() {
+    for (auto &entry : files) {
+        if (entry.second.data != nullptr) {
+            munmap(entry.second.data, entry.second.size);
+        }
+    }
+}
+
+
+bool Density_tile_store::load(const Density_tile_grid &grid,
+        const Density_tile_key &key, const Msis_inputs &weather,
+        Density_tile &tile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Mapping *file = mapping(grid, key, weather);
+    if (file == nullptr) {
+        return false;
+    }
+    int lat_tiles = grid_tiles(180.0 / grid.lat_step, grid.tile_cells);
+    int local_time_tiles = grid_tiles(24.0 / grid.local_time_step,
+            grid.tile_cells);
+    std::uint32_t index = (key.alt_band * lat_tiles + key.lat_band)
+            * local_time_tiles + key.local_time_band;
+    if (index >= file->tile_count || __atomic_load_n(
+            &file->data[sizeof(Store_header) + index], 
+            __ATOMIC_RELAXED) == 0) {
+        return false;
+    }
+    // Pairs with the release fence in save(), here or in another run
+    // ...sharing the file, so the values read are the ones marked present
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const double *values = tile_values(*file, index);
+    tile.assign(values, values + file->node_count);
+    ++load_count;
+    return true;
+}
+
+
+void Density_tile_store::save(const Density_tile_grid &grid,
+        const Density_tile_key &key, const Msis_inputs &weather,
+        const Density_tile &tile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Mapping *file = mapping(grid, key, weather);
+    if (file == nullptr || tile.size() != file->node_count) {
+        return;
+    }
+    int lat_tiles = grid_tiles(180.0 / grid.lat_step, grid.tile_cells);
+    int local_time_tiles = grid_tiles(24.0 / grid.local_time_step,
+            grid.tile_cells);
+    std::uint32_t index = (key.alt_band * lat_tiles + key.lat_band)
+            * local_time_tiles + key.local_time_band;
+    if (index >= file->tile_count) {
+        return;
+    }
+    // Values first, so a tile marked present is always complete. The fence
+    // ...keeps the present byte from becoming visible before them.
+    std::memcpy(tile_values(*file, index), tile.data(),
+            tile.size() * sizeof(double));
+    std::atomic_thread_fence(std::memory_order_release);
+    __atomic_store_n(&file->data[sizeof(Store_header) + index], 1, 
+            __ATOMIC_RELAXED);
+    ++save_count;
+}
+
+
+Density_tile_store::Mapping *Density_tile_store::mapping(
+        const Density_tile_grid &grid, const Density_tile_key &key,
+        const Msis_inputs &weather) {
+    // Mapping of the bucket's file, created at its full size (sparse) the
+    // ...first time any run needs it. nullptr if it cannot be used.
+    if (!usable) {
+        return nullptr;
+    }
+    Store_hash hash;
+    hash.add(model_version.data(), model_version.size());
+    hash.add(index_hash);
+    hash.add(grid.bucket_seconds);
+    hash.add(grid.alt_min);
+    hash.add(grid.alt_max);
+    hash.add(grid.alt_step);
+    hash.add(grid.lat_step);
+    hash.add(grid.local_time_step);
+    hash.add(grid.tile_cells);
+    hash.add(key.epoch_bucket);
+    hash.add(weather.year);
+    hash.add(weather.day_of_year);
+    hash.add(weather.second);
+    hash.add(weather.f107);
+    hash.add(weather.f107a);
+    hash.add(weather.ap);
+    auto found = files.find(hash.value);
+    if (found != files.end()) {
+        found->second.last_used = ++use_clock;
+        return &found->second;
+    }
+
+    // Only added to files once mapped, so a failure is tried again on the
+    // ...next lookup rather than taking a slot for good
+    Mapping file;
+    int edge = grid.tile_cells + 1;
+    file.node_count = edge * edge * edge;
+    file.tile_count = grid_tiles((grid.alt_max - grid.alt_min)
+            / grid.alt_step, grid.tile_cells)
+            * grid_tiles(180.0 / grid.lat_step, grid.tile_cells)
+            * grid_tiles(24.0 / grid.local_time_step, grid.tile_cells);
+    file.size = sizeof(Store_header) + present_bytes(file.tile_count)
+            + std::size_t(file.tile_count) * file.node_count
+            * sizeof(double);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.tiles",
+            static_cast<unsigned long long>(hash.value));
+    std::string path = directory + name;
+    int descriptor = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    // Another run may create the file at the same time. Extending it to 
+    // ...the same size twice is harmless, and its header is written below.
+    struct stat status;
+    if (fstat(descriptor, &status) != 0
+            || (status.st_size == 0 && ftruncate(descriptor, file.size) != 0)
+            || (status.st_size != 0
+            && std::size_t(status.st_size) != file.size)) {
+        close(descriptor);
+        return nullptr;
+    }
+    void *data = mmap(NULL, file.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    file.data = static_cast<unsigned char *>(data);
+
+    // An all-zero header is a file just extended, by this run or another 
+    // ...that has not written its header yet. Both write the same bytes.
+    Store_header header;
+    std::memcpy(header.magic, store_magic, sizeof(store_magic));
+    header.tile_count = file.tile_count;
+    header.node_count = file.node_count;
+    header.hash = hash.value;
+    Store_header blank;
+    std::memset(&blank, 0, sizeof(blank));
+    if (std::memcmp(file.data, &blank, sizeof(blank)) == 0) {
+        std::memcpy(file.data, &header, sizeof(header));
+    }
+    else if (std::memcmp(file.data, &header, sizeof(header)) != 0) {
+        munmap(file.data, file.size);
+        return nullptr;
+    }
+
+    if (files.size() >= max_mappings) {
+        release_least_recent();
+    }
+    file.last_used = ++use_clock;
+    return &(files[hash.value] = file);
+}
+
+
+double *Density_tile_store::tile_values(const Mapping &file,
+        std::uint32_t index) const {
+    return reinterpret_cast<double *>(file.data + sizeof(Store_header)
+            + present_bytes(file.tile_count))
+            + std::size_t(index) * file.node_count;
+}
+
+
+void Density_tile_store::release_least_recent() {
+    // Unmaps the file used longest ago. Called with the mutex held, so no 
+    // ...load or save is using it; the kernel writes back its pages.
+    auto oldest = files.begin();
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        if (it->second.last_used < oldest->second.last_used) {
+            oldest = it;
+        }
+    }
+    if (oldest->second.data != nullptr) {
+        munmap(oldest->second.data, oldest->second.size);
+    }
+    files.erase(oldest);
+}
@@ -0,0 +1,79 @@
+/*! @file Density_tile_store.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Density tiles kept on disk between runs, keyed by model and space
+	weather
+ */
+
+#ifndef DENSITY_TILE_STORE_H
+#define DENSITY_TILE_STORE_H
+
+#include "Density_tile_cache.h"
+#include "Msis_inputs.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Opt-in store of computed tiles in a directory, for re-running the same
+// ...period with other spacecraft parameters without evaluating the model.
+// ...Each epoch bucket is one file named by a hash of the model version,
+// ...the grid, the date and time of the bucket, its F10.7, F10.7A and Ap,
+// ...and the contents of the index files. A file is memory-mapped when
+// ...first used and tiles are read from and written into the mapping. At
+// ...most max_mappings are kept, the least recently used unmapped first.
+// ...When the index files differ from those the directory was made with,
+// ...its files are removed on opening. Runs sharing a directory at the same
+// ...time may both write a tile, with identical values.
+class Density_tile_store {
+public:
+    Density_tile_store(const std::string &in_directory,
+            const std::string &in_model_version,
+            const std::vector<std::string> &index_files,
+            std::size_t in_max_mappings = 64);
+    ~Density_tile_store();
+
+    Density_tile_store(const Density_tile_store &) = delete;
+    Density_tile_store &operator=(const Density_tile_store &) = delete;
+
+    // Tile for key from disk, false if it has not been stored. weather
+    // ...holds the date, second and indices the tile was evaluated with.
+    bool load(const Density_tile_grid &grid, const Density_tile_key &key,
+            const Msis_inputs &weather, Density_tile &tile);
+    void save(const Density_tile_grid &grid, const Density_tile_key &key,
+            const Msis_inputs &weather, const Density_tile &tile);
+
+    bool good() const { return usable; }
+    std::uint64_t loaded() const { return load_count; }
+    std::uint64_t saved() const { return save_count; }
+
+private:
+    struct Mapping {
+        unsigned char *data = nullptr;
+        std::size_t size = 0;
+        std::uint32_t tile_count = 0;
+        std::uint32_t node_count = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    Mapping *mapping(const Density_tile_grid &grid,
+            const Density_tile_key &key, const Msis_inputs &weather);
+    double *tile_values(const Mapping &file, std::uint32_t index) const;
+    void release_least_recent();
+
+    std::string directory;
+    std::string model_version;
+    std::uint64_t index_hash = 0;
+    bool usable = false;
+    std::size_t max_mappings;
+    std::mutex mutex;
+    std::map<std::uint64_t, Mapping> files;
+    std::uint64_t use_clock = 0;
+    std::atomic<std::uint64_t> load_count{0};
+    std::atomic<std::uint64_t> save_count{0};
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*! @file Density_time_slice.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Global density field per epoch, shared by all objects of a catalog
+ */
+
+#include "Density_time_slice.h"
+#include "Density_tile_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+Density_time_slice::Density_time_slice(const Msis_inputs &in_epoch,
+        const Density_grid &in_grid, Density_function in_density)
+        : epoch(in_epoch), grid(in_grid), model(std::move(in_density)) {
+    alt_cells = static_cast<int>(std::ceil(
+            (grid.alt_max - grid.alt_min) / grid.alt_step));
+    lat_cells = static_cast<int>(std::ceil(180.0 / grid.lat_step));
+    lon_cells = static_cast<int>(std::ceil(360.0 / grid.lon_step));
+    alt_tiles = (alt_cells + grid.tile_cells - 1) / grid.tile_cells;
+    lat_tiles = (lat_cells + grid.tile_cells - 1) / grid.tile_cells;
+    lon_tiles = (lon_cells + grid.tile_cells - 1) / grid.tile_cells;
+    int edge = grid.tile_cells + 1;
+    tile_nodes = edge * edge * edge;
+    tiles.reset(new Tile[alt_tiles * lat_tiles * lon_tiles]);
+}
+
+
+double Density_time_slice::density(double alt, double lat, double lon)
+        const {
+    if (!(alt >= grid.alt_min && alt <= grid.alt_max)) {
+        return std::nan("");
+    }
+    // Position in grid cells, the cell it falls in, and how far across it
+    double a = (alt - grid.alt_min) / grid.alt_step;
+    double b = (std::min(std::max(lat, -90.0), 90.0) + 90.0) / grid.lat_step;
+    double c = (std::remainder(lon, 360.0) + 180.0) / grid.lon_step;
+    int i = std::min(static_cast<int>(a), alt_cells - 1);
+    int j = std::min(static_cast<int>(b), lat_cells - 1);
+    int k = std::min(static_cast<int>(c), lon_cells - 1);
+    double fa = a - i, fb = b - j, fc = c - k;
+
+    const Tile &cell_tile = tile(i / grid.tile_cells, j / grid.tile_cells,
+            k / grid.tile_cells);
+    int edge = grid.tile_cells + 1;
+    return tile_interpolate(cell_tile.log_density.data()
+            + ((i % grid.tile_cells) * edge + j % grid.tile_cells) * edge
+            + k % grid.tile_cells, edge, fa, fb, fc);
+}
+
+
+const Density_time_slice::Tile &Density_time_slice::tile(int alt_tile,
+        int lat_tile, int lon_tile) const {
+    Tile &found = tiles[(alt_tile * lat_tiles + lat_tile) * lon_tiles
+            + lon_tile];
+    std::call_once(found.built, [&]() {
+        build(found, alt_tile, lat_tile, lon_tile);
+    });
+    return found;
+}
+
+
+void Density_time_slice::build(Tile &tile, int alt_tile, int lat_tile,
+        int lon_tile) const {
+    // Nodes on the tile's upper edges are shared with the next tile and are
+    // ...evaluated by both, so any cell is interpolated from one tile. Nodes
+    // ...past the end of the grid are left as NaN.
+    int edge = grid.tile_cells + 1;
+    tile.log_density.assign(tile_nodes, std::nan(""));
+    Msis_inputs inputs = epoch;
+    for (int i = 0; i < edge; ++i) {
+        int alt_node = alt_tile * grid.tile_cells + i;
+        if (alt_node > alt_cells) {
+            break;
+        }
+        inputs.alt = grid.alt_min + alt_node * grid.alt_step;
+        for (int j = 0; j < edge; ++j) {
+            int lat_node = lat_tile * grid.tile_cells + j;
+            if (lat_node > lat_cells) {
+                break;
+            }
+            inputs.lat = std::min(-90.0 + lat_node * grid.lat_step, 90.0);
+            for (int k = 0; k < edge; ++k) {
+                int lon_node = lon_tile * grid.tile_cells + k;
+                if (lon_node > lon_cells) {
+                    break;
+                }
+                inputs.lon = std::remainder(-180.0
+                        + lon_node * grid.lon_step, 360.0);
+                double rho = model(inputs);
+                tile.log_density[(i * edge + j) * edge + k] = rho > 0.0
+                        ? std::log(rho) : std::nan("");
+            }
+        }
+    }
+    ++built_count;
+}
+
+
+Density_time_slice_service::Density_time_slice_service(
+        Density_function in_density, const Density_grid &in_grid,
+        std::size_t in_retained)
+        : density(std::move(in_density)), grid(in_grid),
+        retained(std::max<std::size_t>(in_retained, 1)) {}
+
+
+std::shared_ptr<const Density_time_slice> Density_time_slice_service::slice(
+        const Msis_inputs &inputs) {
+    // Only the lookup is under the lock, tiles are built outside it by the
+    // ...threads that need them. An object asking for an epoch older than
+    // ...those retained gets a slice of its own, which is dropped at once.
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::make_tuple(inputs.year, inputs.day_of_year,
+            inputs.second);
+    auto it = slices.find(key);
+    if (it != slices.end()) {
+        return it->second;
+    }
+    auto made_slice = std::make_shared<const Density_time_slice>(inputs,
+            grid, density);
+    slices.emplace(key, made_slice);
+    ++made;
+    while (slices.size() > retained) {
+        slices.erase(slices.begin());
+    }
+    return made_slice;
+}
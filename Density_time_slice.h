@@ -0,0 +1,104 @@
+/*! @file Density_time_slice.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Global density field per epoch, shared by all objects of a catalog
+ */
+
+#ifndef DENSITY_TIME_SLICE_H
+#define DENSITY_TIME_SLICE_H
+
+#include "Msis_inputs.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+// Nodes of the global field: altitude from alt_min to alt_max, latitude
+// ...from -90 to 90 and longitude all the way round from -180, with
+// ...tile_cells grid cells along each edge of a tile
+struct Density_grid {
+    double alt_min = 100.0;     // km
+    double alt_max = 1000.0;    // km
+    double alt_step = 5.0;      // km
+    double lat_step = 5.0;      // deg
+    double lon_step = 7.5;      // deg
+    int tile_cells = 4;
+};
+
+using Density_function = std::function<double(const Msis_inputs &)>;
+
+// Density over the whole globe at one epoch, with the date and indices of
+// ...that epoch. A tile is evaluated the first time a point inside it is
+// ...asked for, by whichever thread asks, and other threads wanting the
+// ...same tile wait for it. Built tiles are never written again, so reads
+// ...are lock-free. Interpolation is trilinear in log density, exact at
+// ...the nodes and following the exponential fall with altitude.
+class Density_time_slice {
+public:
+    Density_time_slice(const Msis_inputs &in_epoch, const Density_grid &in_grid,
+            Density_function in_density);
+
+    // kg/m3 at a point, NaN outside the altitude range of the grid or where
+    // ...the model gave no density, for the caller to evaluate directly
+    double density(double alt, double lat, double lon) const;
+
+    bool same_epoch(const Msis_inputs &inputs) const {
+        return inputs.year == epoch.year
+                && inputs.day_of_year == epoch.day_of_year
+                && inputs.second == epoch.second;
+    }
+
+    const Msis_inputs &inputs() const { return epoch; }
+    std::size_t tiles_built() const { return built_count; }
+
+private:
+    struct Tile {
+        std::once_flag built;
+        std::vector<double> log_density;
+    };
+
+    const Tile &tile(int alt_tile, int lat_tile, int lon_tile) const;
+    void build(Tile &tile, int alt_tile, int lat_tile, int lon_tile) const;
+
+    Msis_inputs epoch;
+    Density_grid grid;
+    Density_function model;
+    int alt_cells, lat_cells, lon_cells;
+    int alt_tiles, lat_tiles, lon_tiles;
+    int tile_nodes;
+    std::unique_ptr<Tile[]> tiles;
+    mutable std::atomic<std::size_t> built_count{0};
+};
+
+// Slices for the epochs an ensemble is being propagated through. Objects
+// ...stepping on a common epoch grid share a slice per epoch, and once
+// ...more than retained epochs are held the earliest is dropped: the
+// ...ensemble has moved on, and the slice is freed when the last object
+// ...still holding it lets go.
+class Density_time_slice_service {
+public:
+    explicit Density_time_slice_service(Density_function in_density,
+            const Density_grid &in_grid = Density_grid(),
+            std::size_t in_retained = 4);
+
+    // Slice for the epoch and indices of inputs, made on first request
+    std::shared_ptr<const Density_time_slice> slice(
+            const Msis_inputs &inputs);
+
+    std::size_t slices_made() const { return made; }
+
+private:
+    Density_function density;
+    Density_grid grid;
+    std::size_t retained;
+    std::mutex mutex;
+    std::map<std::tuple<int, int, double>,
+            std::shared_ptr<const Density_time_slice>> slices;
+    std::atomic<std::size_t> made{0};
+};
+
+#endif
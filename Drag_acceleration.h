@@ -0,0 +1,34 @@
+/*! @file Drag_acceleration.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Drag acceleration from a density, shared by the drag force models
+ */
+
+#ifndef DRAG_ACCELERATION_H
+#define DRAG_ACCELERATION_H
+
+#include "../include/Resident_variables.h"
+#include "Drag_error_log.h"
+#include "Msis_inputs.h"
+
+// Applies density rho at this step: sets the state's density, a_ecef from
+// ...the drag constant minus500C_dAm, adds it to the total acceleration,
+// ...and records a step below 100 km against the epoch in inputs. Every
+// ...drag force model ends its step here, so they cannot drift apart.
+template <typename Vector>
+void apply_drag_density(Resident_variables &state, double minus500C_dAm,
+        double rho, const Msis_inputs &inputs, Drag_error_log &error_log,
+        Vector &a_ecef) {
+    state.atmos_density = rho;
+    a_ecef = minus500C_dAm * rho * state.ecef_v * state.ecef_rso_vel;
+    state.total_a_ecef += a_ecef;
+
+    // Reported to the user on the first occurrence, counted after that
+    if (state.geodetic.alt < 100.0) {
+        error_log.record(Drag_error_code::altitude_too_low, inputs.year,
+                inputs.day_of_year, inputs.second, state.geodetic.alt,
+                state.errors);
+    }
+}
+
+#endif
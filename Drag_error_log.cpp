@@ -0,0 +1,63 @@
+/*! @file Drag_error_log.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fixed-capacity, deduplicated error records for the drag model
+ */
+
+#include "Drag_error_log.h"
+#include <sstream>
+
+void Drag_error_log::record(Drag_error_code code, int year, int day_of_year,
+        double second, double value, std::vector<std::string> &errors) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (records[i].code == code) {
+            ++records[i].count;
+            return;
+        }
+    }
+    if (size == capacity) {
+        ++overflow;
+        return;
+    }
+    records[size++] = {code, year, day_of_year, second, value, 1};
+
+    // Written as compute_acceleration used to write them, once per code
+    std::stringstream error;
+    error.precision(16);
+    switch (code) {
+        case Drag_error_code::altitude_too_low:
+            error << "Force_drag: Altitude too low, " << value << " km.";
+            break;
+    }
+    error << " First at " << year << " day " << day_of_year << " " 
+          << second << " s";
+    errors.push_back(error.str());
+}
+
+
+void Drag_error_log::format_repeats(std::vector<std::string> &errors) const {
+    for (std::size_t i = 0; i < size; ++i) {
+        const Drag_error_record &record = records[i];
+        if (record.count < 2) {
+            continue;
+        }
+        std::stringstream error;
+        switch (record.code) {
+            case Drag_error_code::altitude_too_low:
+                error << "Force_drag: Altitude too low";
+                break;
+        }
+        error << ", " << record.count << " occurrences.";
+        errors.push_back(error.str());
+    }
+    if (overflow > 0) {
+        errors.push_back("Force_drag: " + std::to_string(overflow) 
+                + " further errors not recorded.");
+    }
+}
+
+
+void Drag_error_log::clear() {
+    size = 0;
+    overflow = 0;
+}
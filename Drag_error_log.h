@@ -0,0 +1,55 @@
+/*! @file Drag_error_log.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fixed-capacity, deduplicated error records for the drag model
+ */
+
+#ifndef DRAG_ERROR_LOG_H
+#define DRAG_ERROR_LOG_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class Drag_error_code : std::uint8_t {
+    altitude_too_low,
+};
+
+// First occurrence of an error, with the number of times it has been seen
+struct Drag_error_record {
+    Drag_error_code code;
+    int year;
+    int day_of_year;
+    double second;
+    double value;
+    std::uint32_t count;
+};
+
+// Holds at most one record per error code, so the log cannot grow however 
+// ...long the condition lasts. The first occurrence of each code is 
+// ...reported at once; later ones are only counted, without allocating, 
+// ...and reported by format_repeats().
+class Drag_error_log {
+public:
+    static constexpr std::size_t capacity = 8;
+
+    // On the first occurrence of code since clear(), appends its message to
+    // ...errors, which the propagator checks after each step
+    void record(Drag_error_code code, int year, int day_of_year, 
+            double second, double value, std::vector<std::string> &errors);
+    // Appends the count of each code seen more than once, and of errors 
+    // ...that did not fit
+    void format_repeats(std::vector<std::string> &errors) const;
+    void clear();
+
+    bool empty() const { return size == 0; }
+    std::uint32_t dropped() const { return overflow; }
+
+private:
+    std::array<Drag_error_record, capacity> records;
+    std::size_t size = 0;
+    std::uint32_t overflow = 0;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*! @file Drag_log.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Rate-limited diagnostics for the drag model, written by a sink thread
+ */
+
+#include "Drag_log.h"
+#include <chrono>
+#include <cstdarg>
+
+Drag_log &Drag_log::instance() {
+    static Drag_log log;
+    return log;
+}
+
+
+Drag_log::Drag_log() : sink(&Drag_log::run, this) {}
+
+
+Drag_log::~Drag_log() {
+    // Writes whatever is still queued before the sink thread exits
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    sink.join();
+}
+
+
+bool Drag_log::allow(Drag_log_id id) {
+    // One second windows per id, a race at a window edge only lets the 
+    // ...odd extra message through
+    Rate &rate = rates[static_cast<int>(id)];
+    std::uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::uint64_t start = rate.window_start.load(std::memory_order_relaxed);
+    if (now - start >= 1000000000ull 
+            && rate.window_start.compare_exchange_strong(start, now, 
+            std::memory_order_relaxed)) {
+        rate.window_count.store(0, std::memory_order_relaxed);
+    }
+    if (rate.window_count.fetch_add(1, std::memory_order_relaxed) >= burst) {
+        rate.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+
+void Drag_log::write(Drag_log_id id, const char *format, ...) {
+    if (!allow(id)) {
+        return;
+    }
+    std::array<char, message_length> text;
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(text.data(), text.size(), format, args);
+    va_end(args);
+
+    Rate &rate = rates[static_cast<int>(id)];
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (size == queue_length) {
+            rate.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue[(head + size) % queue_length] = text;
+        ++size;
+    }
+    rate.emitted.fetch_add(1, std::memory_order_relaxed);
+    ready.notify_one();
+}
+
+
+Drag_log_counter Drag_log::counter(Drag_log_id id) const {
+    const Rate &rate = rates[static_cast<int>(id)];
+    Drag_log_counter result;
+    result.emitted = rate.emitted.load(std::memory_order_relaxed);
+    result.suppressed = rate.suppressed.load(std::memory_order_relaxed);
+    return result;
+}
+
+
+void Drag_log::flush() {
+    // Waits until the sink has written everything queued so far
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    drained.wait(lock, [this] { return size == 0 && !writing; });
+}
+
+
+void Drag_log::run() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (true) {
+        ready.wait(lock, [this] { return size > 0 || stopping; });
+        while (size > 0) {
+            // Copy the message out so the queue is not held during I/O
+            std::array<char, message_length> text = queue[head];
+            head = (head + 1) % queue_length;
+            --size;
+            writing = true;
+            lock.unlock();
+            std::fprintf(stderr, "%s\n", text.data());
+            lock.lock();
+            writing = false;
+        }
+        std::fflush(stderr);
+        drained.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
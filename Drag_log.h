@@ -0,0 +1,74 @@
+/*! @file Drag_log.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Rate-limited diagnostics for the drag model, written by a sink thread
+ */
+
+#ifndef DRAG_LOG_H
+#define DRAG_LOG_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+enum class Drag_log_id : int {
+    density_substituted,
+    month_out_of_range,
+    index_file_missing,
+    index_date_missing,
+    count
+};
+
+struct Drag_log_counter {
+    std::uint64_t emitted = 0;
+    std::uint64_t suppressed = 0;   // over the rate limit or queue full
+};
+
+// Messages are formatted by the caller into a fixed slot and written to 
+// ...stderr by a sink thread, so no thread waits on console I/O. Each id 
+// ...may emit burst messages per second; the rest are only counted.
+class Drag_log {
+public:
+    static constexpr int burst = 5;
+    static constexpr std::size_t message_length = 192;
+    static constexpr std::size_t queue_length = 128;
+
+    static Drag_log &instance();
+    ~Drag_log();
+    Drag_log(const Drag_log &) = delete;
+    Drag_log &operator=(const Drag_log &) = delete;
+
+    void write(Drag_log_id id, const char *format, ...)
+            __attribute__((format(printf, 3, 4)));
+    Drag_log_counter counter(Drag_log_id id) const;
+    void flush();
+
+private:
+    Drag_log();
+    bool allow(Drag_log_id id);
+    void run();
+
+    struct Rate {
+        std::atomic<std::uint64_t> window_start{0};
+        std::atomic<std::uint64_t> window_count{0};
+        std::atomic<std::uint64_t> emitted{0};
+        std::atomic<std::uint64_t> suppressed{0};
+    };
+
+    std::array<Rate, static_cast<int>(Drag_log_id::count)> rates;
+    std::array<std::array<char, message_length>, queue_length> queue;
+    std::size_t head = 0;
+    std::size_t size = 0;
+    bool writing = false;
+    bool stopping = false;
+    std::mutex queue_mutex;
+    std::condition_variable ready;
+    std::condition_variable drained;
+    std::thread sink;
+};
+
+#endif
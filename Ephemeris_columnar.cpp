@@ -0,0 +1,315 @@
+/*! @file Ephemeris_columnar.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Compressed columnar binary ephemeris format, writer and reader
+ */
+
+#include "Ephemeris_columnar.h"
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+
+const char file_magic[8] = {'O', 'P', 'S', 'E', 'P', 'H', 'C', '2'};
+const char index_magic[8] = {'O', 'P', 'S', 'E', 'P', 'H', 'I', '2'};
+const int column_count = 11;
+
+// Bounds on an encoded block: a residual is 1 to 9 bytes, and deflate 
+// ...expands by at most 1032 to 1
+const std::uint64_t max_residual_bytes = 9;
+const std::uint64_t max_deflate_ratio = 1032;
+
+double *column(Ephemeris_record &record, int c) {
+    // Column order: epoch, position, velocity, density, drag
+    if (c == 0) {
+        return &record.epoch;
+    }
+    if (c < 4) {
+        return &record.position[c - 1];
+    }
+    if (c < 7) {
+        return &record.velocity[c - 4];
+    }
+    if (c == 7) {
+        return &record.atmos_density;
+    }
+    return &record.drag[c - 8];
+}
+
+std::uint64_t to_bits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double from_bits(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double predict(std::size_t i, double previous, double before) {
+    // Linear extrapolation from the two values before, in the block only
+    if (i == 0) {
+        return 0.0;
+    }
+    if (i == 1) {
+        return previous;
+    }
+    return previous + (previous - before);
+}
+
+void encode_residual(std::uint64_t residual, 
+        std::vector<unsigned char> &out) {
+    // Header byte holds the zero bytes dropped from each end
+    int lead = residual == 0 ? 8 : __builtin_clzll(residual) / 8;
+    int trail = residual == 0 ? 0 : __builtin_ctzll(residual) / 8;
+    out.push_back(static_cast<unsigned char>((lead << 4) | trail));
+    for (int byte = 7 - lead; byte >= trail; --byte) {
+        out.push_back(static_cast<unsigned char>(residual >> (8 * byte)));
+    }
+}
+
+bool decode_residual(const unsigned char *&in, const unsigned char *end, 
+        std::uint64_t &residual) {
+    if (in == end) {
+        return false;
+    }
+    int lead = *in >> 4;
+    int trail = *in & 0x0f;
+    ++in;
+    if (lead > 8 || trail > 8 || lead + trail > 8 
+            || end - in < 8 - lead - trail) {
+        return false;
+    }
+    residual = 0;
+    for (int byte = 7 - lead; byte >= trail; --byte) {
+        residual |= static_cast<std::uint64_t>(*in++) << (8 * byte);
+    }
+    return true;
+}
+
+}
+
+Columnar_ephemeris_writer::Columnar_ephemeris_writer(const std::string &path,
+        std::size_t in_block_records) 
+        : file(std::fopen(path.c_str(), "wb")), 
+        block_records(in_block_records > 0 ? in_block_records : 1) {
+    pending.reserve(block_records);
+    if (file != NULL) {
+        std::fwrite(file_magic, sizeof(file_magic), 1, file);
+    }
+}
+
+
+Columnar_ephemeris_writer::~Columnar_ephemeris_writer() {
+    close();
+}
+
+
+void Columnar_ephemeris_writer::append(const Ephemeris_record &record) {
+    pending.push_back(record);
+    if (pending.size() == block_records) {
+        write_block();
+    }
+}
+
+
+void Columnar_ephemeris_writer::write_block() {
+    if (pending.empty() || file == NULL) {
+        return;
+    }
+    encoded.clear();
+    for (int c = 0; c < column_count; ++c) {
+        double previous = 0.0, before = 0.0;
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            double value = *column(pending[i], c);
+            encode_residual(to_bits(value) 
+                    ^ to_bits(predict(i, previous, before)), encoded);
+            before = previous;
+            previous = value;
+        }
+    }
+    Ephemeris_block_index entry;
+    entry.first_epoch = pending.front().epoch;
+    entry.last_epoch = pending.back().epoch;
+    entry.offset = static_cast<std::uint64_t>(std::ftell(file));
+    entry.records = pending.size();
+    index.push_back(entry);
+
+    // Stored deflated unless that is no smaller, when the stored size 
+    // ...equals the encoded size
+    uLongf stored = compressBound(encoded.size());
+    compressed.resize(stored);
+    const std::vector<unsigned char> *block = &compressed;
+    if (compress2(compressed.data(), &stored, encoded.data(), 
+            encoded.size(), Z_DEFAULT_COMPRESSION) != Z_OK 
+            || stored >= encoded.size()) {
+        block = &encoded;
+        stored = encoded.size();
+    }
+    std::uint64_t header[3] = {entry.records, encoded.size(), stored};
+    std::fwrite(header, sizeof(header), 1, file);
+    std::fwrite(block->data(), 1, stored, file);
+    pending.clear();
+}
+
+
+bool Columnar_ephemeris_writer::close() {
+    // Writes the last partial block, the index and the footer
+    if (file == NULL) {
+        return false;
+    }
+    write_block();
+    std::uint64_t index_offset = static_cast<std::uint64_t>(std::ftell(file));
+    std::fwrite(index.data(), sizeof(Ephemeris_block_index), index.size(), 
+            file);
+    std::uint64_t footer[2] = {index_offset, index.size()};
+    std::fwrite(footer, sizeof(footer), 1, file);
+    std::fwrite(index_magic, sizeof(index_magic), 1, file);
+    bool ok = std::fclose(file) == 0;
+    file = NULL;
+    return ok;
+}
+
+
+Columnar_ephemeris_reader::Columnar_ephemeris_reader(const std::string &path)
+        : file(std::fopen(path.c_str(), "rb")) {
+    // Checks both magics and loads the block index from the footer. The 
+    // ...index must run from its offset exactly to the footer.
+    char magic[8];
+    std::uint64_t footer[2];
+    if (file == NULL) {
+        return;
+    }
+    bool ok = std::fread(magic, sizeof(magic), 1, file) == 1 
+            && std::memcmp(magic, file_magic, sizeof(magic)) == 0
+            && std::fseek(file, 0, SEEK_END) == 0;
+    long end = ok ? std::ftell(file) : -1;
+    std::uint64_t trailer = sizeof(footer) + sizeof(magic);
+    ok = end >= static_cast<long>(sizeof(file_magic) + trailer);
+    if (ok) {
+        file_size = static_cast<std::uint64_t>(end);
+        ok = std::fseek(file, -static_cast<long>(trailer), SEEK_END) == 0
+                && std::fread(footer, sizeof(footer), 1, file) == 1
+                && std::fread(magic, sizeof(magic), 1, file) == 1
+                && std::memcmp(magic, index_magic, sizeof(magic)) == 0;
+    }
+    std::uint64_t index_end = file_size - trailer;
+    ok = ok && footer[0] >= sizeof(file_magic) && footer[0] <= index_end
+            && footer[1] == (index_end - footer[0]) 
+            / sizeof(Ephemeris_block_index)
+            && (index_end - footer[0]) % sizeof(Ephemeris_block_index) == 0
+            && std::fseek(file, static_cast<long>(footer[0]), SEEK_SET) == 0;
+    if (ok) {
+        index.resize(footer[1]);
+        ok = std::fread(index.data(), sizeof(Ephemeris_block_index), 
+                index.size(), file) == index.size();
+    }
+    if (!ok) {
+        index.clear();
+        std::fclose(file);
+        file = NULL;
+    }
+}
+
+
+Columnar_ephemeris_reader::~Columnar_ephemeris_reader() {
+    if (file != NULL) {
+        std::fclose(file);
+    }
+}
+
+
+bool Columnar_ephemeris_reader::read_block(std::size_t block, 
+        std::vector<Ephemeris_record> &out) {
+    // Appends the records of one block to out
+    if (file == NULL || block >= index.size()) {
+        return false;
+    }
+    // Header is records, encoded size and stored size, each checked before
+    // ...anything is sized from it
+    std::uint64_t header[3];
+    std::uint64_t offset = index[block].offset;
+    if (offset > file_size || file_size - offset < sizeof(header)
+            || std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0 
+            || std::fread(header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+    std::uint64_t records = header[0];
+    std::uint64_t encoded_size = header[1];
+    std::uint64_t stored_size = header[2];
+    if (records != index[block].records 
+            || stored_size > file_size - offset - sizeof(header)
+            || stored_size > encoded_size
+            || encoded_size / column_count < records
+            || encoded_size / column_count / max_residual_bytes > records
+            || encoded_size / max_deflate_ratio > stored_size) {
+        return false;
+    }
+    encoded.resize(encoded_size);
+    if (stored_size == encoded_size) {
+        if (std::fread(encoded.data(), 1, encoded.size(), file) 
+                != encoded.size()) {
+            return false;
+        }
+    }
+    else {
+        compressed.resize(stored_size);
+        uLongf length = encoded_size;
+        if (std::fread(compressed.data(), 1, compressed.size(), file) 
+                != compressed.size()
+                || uncompress(encoded.data(), &length, compressed.data(), 
+                compressed.size()) != Z_OK 
+                || length != encoded_size) {
+            return false;
+        }
+    }
+
+    std::size_t first = out.size();
+    out.resize(first + records);
+    const unsigned char *in = encoded.data();
+    const unsigned char *end = in + encoded.size();
+    for (int c = 0; c < column_count; ++c) {
+        double previous = 0.0, before = 0.0;
+        for (std::size_t i = 0; i < records; ++i) {
+            std::uint64_t residual;
+            if (!decode_residual(in, end, residual)) {
+                out.resize(first);
+                return false;
+            }
+            double value = from_bits(residual 
+                    ^ to_bits(predict(i, previous, before)));
+            *column(out[first + i], c) = value;
+            before = previous;
+            previous = value;
+        }
+    }
+    return true;
+}
+
+
+bool Columnar_ephemeris_reader::read_range(double start_epoch, 
+        double end_epoch, std::vector<Ephemeris_record> &out) {
+    // Reads only the blocks that overlap [start_epoch, end_epoch], found by 
+    // ...binary search of the index, then trims to the range
+    auto it = std::lower_bound(index.begin(), index.end(), start_epoch, 
+            [](const Ephemeris_block_index &entry, double epoch) {
+                return entry.last_epoch < epoch;
+            });
+    std::vector<Ephemeris_record> block;
+    for (; it != index.end() && it->first_epoch <= end_epoch; ++it) {
+        block.clear();
+        if (!read_block(static_cast<std::size_t>(it - index.begin()), 
+                block)) {
+            return false;
+        }
+        for (const Ephemeris_record &record : block) {
+            if (record.epoch >= start_epoch && record.epoch <= end_epoch) {
+                out.push_back(record);
+            }
+        }
+    }
+    return true;
+}
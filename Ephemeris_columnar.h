@@ -0,0 +1,81 @@
+/*! @file Ephemeris_columnar.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Compressed columnar binary ephemeris format, writer and reader
+ */
+
+#ifndef EPHEMERIS_COLUMNAR_H
+#define EPHEMERIS_COLUMNAR_H
+
+#include "Ephemeris_writer.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// File layout: 8 byte magic, then blocks of up to block_records steps, then 
+// ...the block index and a footer giving its offset. Within a block each of 
+// ...the 11 columns (epoch, position, velocity, density, drag) is stored in 
+// ...turn. Every value is XORed with its linear prediction from the two 
+// ...before it, and only the non-zero bytes of the result are kept, so 
+// ...smooth columns shrink to a byte or two per value. Each block is then
+// ...deflated with zlib (link with -lz), and kept as it is if that does not
+// ...make it smaller. The encoding is lossless and each block decodes on 
+// ...its own. Counts read back are checked against the file size, so a 
+// ...truncated or corrupt file fails to open or read rather than throwing.
+struct Ephemeris_block_index {
+    double first_epoch;
+    double last_epoch;
+    std::uint64_t offset;
+    std::uint64_t records;
+};
+
+class Columnar_ephemeris_writer {
+public:
+    explicit Columnar_ephemeris_writer(const std::string &path, 
+            std::size_t in_block_records = 4096);
+    ~Columnar_ephemeris_writer();
+    Columnar_ephemeris_writer(const Columnar_ephemeris_writer &) = delete;
+    Columnar_ephemeris_writer &operator=(
+            const Columnar_ephemeris_writer &) = delete;
+
+    bool good() const { return file != NULL; }
+    void append(const Ephemeris_record &record);
+    bool close();
+
+private:
+    void write_block();
+
+    std::FILE *file;
+    std::size_t block_records;
+    std::vector<Ephemeris_record> pending;
+    std::vector<unsigned char> encoded;
+    std::vector<unsigned char> compressed;
+    std::vector<Ephemeris_block_index> index;
+};
+
+class Columnar_ephemeris_reader {
+public:
+    explicit Columnar_ephemeris_reader(const std::string &path);
+    ~Columnar_ephemeris_reader();
+    Columnar_ephemeris_reader(const Columnar_ephemeris_reader &) = delete;
+    Columnar_ephemeris_reader &operator=(
+            const Columnar_ephemeris_reader &) = delete;
+
+    bool good() const { return file != NULL; }
+    const std::vector<Ephemeris_block_index> &blocks() const { 
+        return index; 
+    }
+    bool read_block(std::size_t block, std::vector<Ephemeris_record> &out);
+    bool read_range(double start_epoch, double end_epoch, 
+            std::vector<Ephemeris_record> &out);
+
+private:
+    std::FILE *file;
+    std::uint64_t file_size = 0;
+    std::vector<Ephemeris_block_index> index;
+    std::vector<unsigned char> encoded;
+    std::vector<unsigned char> compressed;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/*! @file Ephemeris_writer.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Double-buffered ephemeris output written by a background thread
+ */
+
+#include "Ephemeris_writer.h"
+
+namespace {
+
+// Longest line append() can produce, 11 fields of at most 25 characters
+const std::size_t max_line = 11 * 25 + 2;
+
+}
+
+Ephemeris_writer::Ephemeris_writer(const std::string &path, 
+        std::size_t buffer_bytes) 
+        : file(std::fopen(path.c_str(), "w")), 
+        capacity(buffer_bytes > 2 * max_line ? buffer_bytes : 2 * max_line) {
+    current.data.reset(new char[capacity]);
+    Buffer second;
+    second.data.reset(new char[capacity]);
+    spare.push_back(std::move(second));
+    if (file != NULL) {
+        std::fprintf(file, "# epoch_s x_km y_km z_km vx_km_s vy_km_s "
+                "vz_km_s rho_kg_m3 ax ay az\n");
+    }
+    writer = std::thread(&Ephemeris_writer::run, this);
+}
+
+
+Ephemeris_writer::~Ephemeris_writer() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+    if (file != NULL) {
+        std::fclose(file);
+    }
+}
+
+
+void Ephemeris_writer::append(const Ephemeris_record &record) {
+    // %.17g keeps every double exactly, so the text round-trips
+    if (capacity - current.used < max_line) {
+        hand_off();
+    }
+    int length = std::snprintf(current.data.get() + current.used, 
+            capacity - current.used, "%.17g %.17g %.17g %.17g %.17g %.17g "
+            "%.17g %.17g %.17g %.17g %.17g\n", record.epoch, 
+            record.position[0], record.position[1], record.position[2], 
+            record.velocity[0], record.velocity[1], record.velocity[2], 
+            record.atmos_density, record.drag[0], record.drag[1], 
+            record.drag[2]);
+    if (length > 0) {
+        current.used += static_cast<std::size_t>(length);
+    }
+}
+
+
+void Ephemeris_writer::hand_off() {
+    // Queues the current buffer and takes a spare, never waiting on I/O
+    if (current.used == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        full.push_back(std::move(current));
+        if (!spare.empty()) {
+            current = std::move(spare.back());
+            spare.pop_back();
+        }
+        else {
+            current = Buffer();
+        }
+    }
+    if (!current.data) {
+        current.data.reset(new char[capacity]);
+    }
+    current.used = 0;
+    ready.notify_one();
+}
+
+
+void Ephemeris_writer::flush() {
+    // Blocks until everything appended so far is on disk, for end of run
+    hand_off();
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    drained.wait(lock, [this] { return full.empty() && !writing; });
+    if (file != NULL) {
+        std::fflush(file);
+    }
+}
+
+
+void Ephemeris_writer::run() {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    while (true) {
+        ready.wait(lock, [this] { return !full.empty() || stopping; });
+        while (!full.empty()) {
+            Buffer buffer = std::move(full.front());
+            full.pop_front();
+            writing = true;
+            lock.unlock();
+            if (file != NULL) {
+                std::fwrite(buffer.data.get(), 1, buffer.used, file);
+            }
+            buffer.used = 0;
+            lock.lock();
+            writing = false;
+            spare.push_back(std::move(buffer));
+        }
+        drained.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*! @file Ephemeris_writer.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Double-buffered ephemeris output written by a background thread
+ */
+
+#ifndef EPHEMERIS_WRITER_H
+#define EPHEMERIS_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One integrator step as recorded in the ephemeris
+struct Ephemeris_record {
+    double epoch;           // seconds from the start of the run
+    double position[3];     // ECEF, km
+    double velocity[3];     // ECEF, km/s
+    double atmos_density;   // kg/m3, state->atmos_density
+    double drag[3];         // drag acceleration a_ecef
+};
+
+// Formats records as text into preallocated buffers on the caller's thread 
+// ...and hands each full buffer to a writer thread. Two buffers are made 
+// ...up front; if the writer falls behind another is allocated rather than 
+// ...making the integrator wait on the disk.
+class Ephemeris_writer {
+public:
+    explicit Ephemeris_writer(const std::string &path, 
+            std::size_t buffer_bytes = 1 << 20);
+    ~Ephemeris_writer();
+    Ephemeris_writer(const Ephemeris_writer &) = delete;
+    Ephemeris_writer &operator=(const Ephemeris_writer &) = delete;
+
+    bool good() const { return file != NULL; }
+    void append(const Ephemeris_record &record);
+    void flush();
+
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        std::size_t used = 0;
+    };
+
+    void hand_off();
+    void run();
+
+    std::FILE *file;
+    std::size_t capacity;
+    Buffer current;
+    std::deque<Buffer> full;
+    std::vector<Buffer> spare;
+    bool writing = false;
+    bool stopping = false;
+    std::mutex buffer_mutex;
+    std::condition_variable ready;
+    std::condition_variable drained;
+    std::thread writer;
+};
+
+#endif
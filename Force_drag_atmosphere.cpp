@@ -0,0 +1,40 @@
+/*! @file Force_drag_atmosphere.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Drag force model specialised at compile time on an atmosphere model
+ */
+
+#include "Force_drag_atmosphere.h"
+#include "Tiled_atmosphere.h"
+
+// Specialisations built here, so users of the header need not instantiate
+template class Force_drag_atmosphere<Nrlmsise00_atmosphere>;
+template class Force_drag_atmosphere<Exponential_atmosphere>;
+template class Force_drag_atmosphere<Ussa76_atmosphere>;
+template class Force_drag_atmosphere<Tabulated_atmosphere>;
+template class Force_drag_atmosphere<Runtime_atmosphere>;
+template class Force_drag_atmosphere<Tiled_atmosphere<Nrlmsise00_atmosphere>>;
+
+std::unique_ptr<Force_drag> make_force_drag(const std::string &atmosphere,
+        const std::string &table_file) {
+    if (atmosphere == "nrlmsise00") {
+        return std::make_unique<Force_drag_atmosphere<
+                Nrlmsise00_atmosphere>>();
+    }
+    if (atmosphere == "exponential") {
+        return std::make_unique<Force_drag_atmosphere<
+                Exponential_atmosphere>>();
+    }
+    if (atmosphere == "ussa76") {
+        return std::make_unique<Force_drag_atmosphere<Ussa76_atmosphere>>();
+    }
+    if (atmosphere == "tabulated") {
+        Tabulated_atmosphere table = Tabulated_atmosphere::from_file(
+                table_file);
+        if (table.good()) {
+            return std::make_unique<Force_drag_atmosphere<
+                    Tabulated_atmosphere>>(std::move(table));
+        }
+    }
+    return nullptr;
+}
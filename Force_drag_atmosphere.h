@@ -0,0 +1,79 @@
+/*! @file Force_drag_atmosphere.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Drag force model specialised at compile time on an atmosphere model
+ */
+
+#ifndef FORCE_DRAG_ATMOSPHERE_H
+#define FORCE_DRAG_ATMOSPHERE_H
+
+#include "../include/Resident_space_object.h"
+#include "../include/Resident_variables.h"
+#include "Atmosphere_models.h"
+#include "Drag_acceleration.h"
+#include "Drag_error_log.h"
+#include <memory>
+#include <string>
+#include <utility>
+
+// Drag force with the atmosphere model as a template parameter, so the 
+// ...density call is resolved and inlined at compile time. The class is 
+// ...final, letting calls through a known concrete type be devirtualised.
+template <typename Atmosphere>
+class Force_drag_atmosphere final : public Force_drag {
+public:
+    explicit Force_drag_atmosphere(Atmosphere in_atmosphere = Atmosphere()) 
+            : atmosphere(std::move(in_atmosphere)) {}
+
+    void setup(const Resident_constants &rso_const,
+            std::shared_ptr<Resident_variables> in_state) override {
+        Force_drag::setup(rso_const, in_state);
+    }
+
+    void compute_acceleration() override {
+        // Epoch and indices are only looked up for models that use them
+        Msis_inputs inputs;
+        if (atmosphere.needs_space_weather()) {
+            inputs = Force_drag_nrlmsise00::msis_inputs(
+                    state->eci.epoch.str_UTC_datestamp(), 
+                    state->geodetic.alt, state->geodetic.lat, 
+                    state->geodetic.lon);
+        }
+        else {
+            inputs.alt = state->geodetic.alt;
+            inputs.lat = state->geodetic.lat;
+            inputs.lon = state->geodetic.lon;
+            // The date is only needed to report a step below 100 km
+            if (inputs.alt < 100.0) {
+                auto [day_of_year, previous_day, f10_year, second, day, 
+                        month, year] = Force_drag_nrlmsise00::msis_time_stamp(
+                        state->eci.epoch.str_UTC_datestamp());
+                inputs.year = year;
+                inputs.day_of_year = day_of_year;
+                inputs.second = second;
+            }
+        }
+        apply_drag_density(*state, minus500C_dAm, 
+                atmosphere.density(inputs), inputs, error_log, a_ecef);
+    }
+
+    void report_errors() {
+        error_log.format_repeats(state->errors);
+        error_log.clear();
+    }
+
+    const Atmosphere &model() const { return atmosphere; }
+
+private:
+    Atmosphere atmosphere;
+    Drag_error_log error_log;
+};
+
+// Drag force for an atmosphere named in configuration: "nrlmsise00", 
+// ..."exponential", "ussa76", or "tabulated" from table_file. Each is its 
+// ...own specialisation, so the choice costs nothing per step. Returns 
+// ...nullptr for an unknown name or a table that cannot be used.
+std::unique_ptr<Force_drag> make_force_drag(const std::string &atmosphere,
+        const std::string &table_file = std::string());
+
+#endif
@@ -6,379 +6,691 @@
 
 #include "../include/Resident_space_object.h"
 #include "../include/Resident_variables.h"
-#include <unistd.h>
+#include "Force_drag_stats.h"
+#include "Latency_histogram.h"
+#include "Trace_recorder.h"
+#include "Atmosphere_models.h"
+#include "Density_capture.h"
+#include "Density_pipeline.h"
+#include "Density_speculator.h"
+#include "Density_time_slice.h"
+#include "Drag_acceleration.h"
+#include "Drag_error_log.h"
+#include "Drag_log.h"
+#include "Msis_inputs.h"
+#include "Nrlmsise00_model.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <vector>
+#ifdef FORCE_DRAG_STAGE_STATS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace {
+
+// Locations of the index files, overridable from the environment so that 
+// ...runs and benchmarks can point at synthetic copies
+std::string msis_path(const char *env_name, const char *default_path) {
+    const char *path = std::getenv(env_name);
+    return path != NULL ? std::string(path) : std::string(default_path);
+}
+
+const std::string &msis_f107_file() {
+    static const std::string path = msis_path("OPS_MSIS_F107_FILE", 
+            "/Users/johnkeeling/Desktop/Astrophysics_MSc/PHAS0062_research"
+            "_project/hawke_files/msis-model_c/DATA/SOLFSMY.TXT");
+    return path;
+}
+
+const std::string &msis_ap_file() {
+    static const std::string path = msis_path("OPS_MSIS_AP_FILE", 
+            "/Users/johnkeeling/Desktop/Astrophysics_MSc/PHAS0062_research"
+            "_project/hawke_files/msis-model_c/DATA/apindex");
+    return path;
+}
+
+// Daily solar flux from SOLFSMY.TXT, sorted by year and day of year
+struct F107_entry {
+    int year;
+    int day_of_year;
+    double f107;
+    double f107a;
+};
+
+// Daily average Ap from apindex, sorted by yymmdd date
+struct Ap_entry {
+    int date;
+    double ap;
+};
+
+std::vector<F107_entry> load_f107_table(const std::string &path) {
+    // Columns are year, day of year, JD, F10, F81c, then S, M and Y indices
+    std::vector<F107_entry> table;
+    std::ifstream inFileF107(path);
+    if(!inFileF107){
+        Drag_log::instance().write(Drag_log_id::index_file_missing, 
+                "Force_drag: Unable to open F10.7 file %s", path.c_str());
+    }
+    std::string line;
+    while (getline(inFileF107, line)) {
+        F107_entry entry;
+        double julian_date;
+        if (line.empty() || line[0] == '#' 
+                || std::sscanf(line.c_str(), "%d %d %lf %lf %lf", &entry.year,
+                &entry.day_of_year, &julian_date, &entry.f107, 
+                &entry.f107a) != 5) {
+            continue;
+        }
+        table.push_back(entry);
+    }
+    std::stable_sort(table.begin(), table.end(), 
+            [](const F107_entry &a, const F107_entry &b) {
+                return std::make_pair(a.year, a.day_of_year) 
+                        < std::make_pair(b.year, b.day_of_year);
+            });
+    return table;
+}
+
+std::vector<Ap_entry> load_ap_table(const std::string &path) {
+    // yymmdd in the first 6 columns, eight 3-hourly Ap values from column 31
+    std::vector<Ap_entry> table;
+    std::ifstream inFileAp(path);
+    if(!inFileAp){
+        Drag_log::instance().write(Drag_log_id::index_file_missing, 
+                "Force_drag: Unable to open Ap file %s", path.c_str());
+    }
+    std::string line;
+    while (getline(inFileAp, line)) {
+        if (line.length() < 55) {
+            continue;
+        }
+        Ap_entry entry;
+        entry.date = std::atoi(line.substr(0, 6).c_str());
+        int sum = 0;
+        for (int i = 0; i < 8; ++i) {
+            sum += std::atoi(line.substr(31 + 3 * i, 3).c_str());
+        }
+        entry.ap = round(float(sum) / 8);
+        table.push_back(entry);
+    }
+    // Stable, so a repeated date resolves to its last line as before
+    std::stable_sort(table.begin(), table.end(), 
+            [](const Ap_entry &a, const Ap_entry &b) {
+                return a.date < b.date;
+            });
+    return table;
+}
+
+const std::vector<F107_entry> &f107_table() {
+    static const std::vector<F107_entry> table 
+            = load_f107_table(msis_f107_file());
+    return table;
+}
+
+const std::vector<Ap_entry> &ap_table() {
+    static const std::vector<Ap_entry> table = load_ap_table(msis_ap_file());
+    return table;
+}
+
+bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Value as the model receives it: fixed-point text cut to 8 characters
+double msis_truncate(double value) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.15f", value);
+    text[8] = '\0';
+    return std::strtod(text, NULL);
+}
+
+// Capture log of every evaluation, opened when OPS_DRAG_CAPTURE is set
+Density_capture *drag_capture() {
+    static const char *path = std::getenv("OPS_DRAG_CAPTURE");
+    static std::unique_ptr<Density_capture> capture = path != NULL 
+            ? std::make_unique<Density_capture>(path) : nullptr;
+    return capture != nullptr && capture->good() ? capture.get() : nullptr;
+}
+
+// Latency of compute_acceleration over all instances and threads
+Latency_recorder &drag_latency() {
+    static Latency_recorder recorder("compute_acceleration");
+    return recorder;
+}
+
+#ifdef FORCE_DRAG_STAGE_STATS
+// Cycle counter, steady clock nanoseconds where there is no TSC
+inline std::uint64_t drag_stage_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline void drag_stage_record(Drag_stage_counter &counter, 
+        std::uint64_t start) {
+    std::uint64_t elapsed = drag_stage_clock() - start;
+    ++counter.calls;
+    counter.cycles += elapsed;
+    if (elapsed > counter.max_cycles) {
+        counter.max_cycles = elapsed;
+    }
+}
+
+#endif
+
+// Each stage is a trace span, and is timed into stage_stats when enabled
+#ifdef FORCE_DRAG_STAGE_STATS
+#define DRAG_STAGE_START(stage) \
+    Trace_span stage##_span(#stage); \
+    std::uint64_t stage##_start = drag_stage_clock()
+#define DRAG_STAGE_STOP(stage) \
+    drag_stage_record(stage_stats.stage, stage##_start); \
+    stage##_span.end()
+#else
+#define DRAG_STAGE_START(stage) Trace_span stage##_span(#stage)
+#define DRAG_STAGE_STOP(stage) stage##_span.end()
+#endif
+
+}
 
 void Force_drag_nrlmsise00::setup(const Resident_constants &rso_const,
                               std::shared_ptr<Resident_variables> in_state) {
      Force_drag::setup(rso_const, in_state);
+     // Index files are read here once, not scanned on every step. Without
+     // ...them every MSIS step would substitute, so the run is stopped.
+     if (f107_table().empty()) {
+         state->errors.push_back("Force_drag: No F10.7 values read from " 
+                 + msis_f107_file() + ".");
+     }
+     if (ap_table().empty()) {
+         state->errors.push_back("Force_drag: No Ap values read from " 
+                 + msis_ap_file() + ".");
+     }
 }
 
 
 void Force_drag_nrlmsise00::compute_acceleration() {
-    // Report error, this displays the issue to the user and halts simulation
-    if (state->geodetic.alt < 100.0) {
-        std::stringstream error;
-        error.precision(16);
-        error << "Force_drag: Altitude too low, " << state->geodetic.alt
-              << " km.";
-        state->errors.push_back(error.str());
+    Trace_span span("compute_acceleration");
+    auto start = std::chrono::steady_clock::now();
+
+    double rho;
+    if (select_exponential_tier()) {
+        rho = Exponential_atmosphere::altitude_density(state->geodetic.alt);
     }
+    else {
+        rho = nrlmsise00_density(state->geodetic.alt, 
+                state->geodetic.lat, state->geodetic.lon);
+    }
+    apply_density(rho);
 
-    // USSA up to 1000 km, with exponential decay function above
-    double rho = nrlmsise00_density(state->geodetic.alt, state->geodetic.lat,
-            state->geodetic.lon);
-    state->atmos_density = rho;
-    a_ecef = minus500C_dAm * rho * state->ecef_v * state->ecef_rso_vel;
-    state->total_a_ecef += a_ecef;
+    drag_latency().record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
 }
 
 
-double Force_drag_nrlmsise00::nrlmsise00_density(double alt, double lat, 
-        double lon) {
-    // Retrieves mass density from atmos. model for given time and location
+void Force_drag_nrlmsise00::submit_acceleration(Density_channel &channel) {
+    // First half of compute_acceleration for a pipelined ensemble: the 
+    // ...NRLMSISE-00 density is requested from the pipeline's workers, and 
+    // ...complete_acceleration() applies it once the integrator thread has 
+    // ...done its other work. Time slices and speculation are not used.
+    pending_msis = begin_acceleration(last_inputs);
+    if (pending_msis) {
+        channel.submit(last_inputs, completion);
+    }
+}
 
-    auto [altitude, latitude, longitude] = msis_lla_coordinates(alt, lat, lon);
-    auto [day_of_year, previous_day, f10_year, second, day, month, year] 
-            = msis_time_stamp(state->eci.epoch.str_UTC_datestamp());
-    auto [F107_value, F107A_value] 
-            = msis_f107(previous_day, f10_year);
-    std::string Ap_value = ap_value(year, month, day);
-    double rho = retrieve_mass_density(day_of_year, year, second, altitude, 
-            latitude, longitude, F107_value, F107A_value, Ap_value);
 
-    return rho;
+void Force_drag_nrlmsise00::complete_acceleration() {
+    // Second half, waits for the density if it is not back yet
+    if (pending_msis) {
+        finish_acceleration(completion.wait());
+        pending_msis = false;
+    }
+}
 
-};
 
-std::tuple<std::string, std::string, 
-        std::string> Force_drag_nrlmsise00::msis_lla_coordinates(double alt, 
-        double lat, double lon) {
-    // Retrieves latitude, longitude and altitude coordinates
+bool Force_drag_nrlmsise00::begin_acceleration(Msis_inputs &inputs) {
+    // Start of a step whose model density is evaluated elsewhere, by a 
+    // ...pipeline or a Density_scheduler. Above the ceiling the exponential
+    // ...tier is applied here and false returned, otherwise inputs are set
+    // ...for the model and finish_acceleration() takes its density.
+    if (select_exponential_tier()) {
+        apply_density(Exponential_atmosphere::altitude_density(
+                state->geodetic.alt));
+        return false;
+    }
+    inputs = msis_point_inputs(state->geodetic.alt, state->geodetic.lat,
+            state->geodetic.lon);
+    last_inputs = inputs;
+    return true;
+}
 
-    std::string model_latitude, model_longitude, model_altitude;
-    std::stringstream model_output;
 
-    model_output << std::fixed << std::setprecision(15) << std::setw(18)
-                  << lat << " " << std::setw(18) << lon << " " << std::setw(18)
-                  << alt << " " << std::setw(18);
-    model_output >> model_latitude >> model_longitude >> model_altitude;
-    if (model_latitude.length() > 8) {
-        std::string str_new = model_latitude.substr (0, 8);
-        model_latitude = str_new;
-    }
-    if (model_longitude.length() > 8) {
-        std::string str_new = model_longitude.substr (0, 8);
-        model_longitude = str_new;
+void Force_drag_nrlmsise00::finish_acceleration(double rho) {
+    if (Density_capture *capture = drag_capture()) {
+        capture->append(last_inputs, rho);
     }
-    if (model_altitude.length() > 9) {
-        std::string str_new = model_altitude.substr (0, 8);
-        model_altitude = str_new;
-    }
-    return {model_altitude, model_latitude, model_longitude};
-};
-
+    apply_density(rho);
+}
 
-std::tuple<std::string, std::string, std::string, std::string, std::string, 
-        std::string, std::string> Force_drag_nrlmsise00::msis_time_stamp(
-        std::string epoch) {
-    // Retrieves time stamp for MSIS model in specified format
 
-    std::string mod_str1, mod_str2, mod_str3, mod_str4, oneWord, 
-        break_str, model_year, model_month, model_day, model_hour, 
-        model_minute, model_second;
-    std::stringstream model_utc1, model_utc2, stream_sec, stream_day, 
-        stream_month, stream_year;
-    int int_year, int_month, int_day;
-    
-    // Retrieves UTC timestamp and parses
-    model_utc1 << epoch;
-    int count = 0;
-    while(model_utc1 >> oneWord) { ++count;}
-    model_utc2 << epoch;
-    if (count == 3) {
-        model_utc2 >> break_str >> mod_str3 >> mod_str4;
-        unsigned slash1 = break_str.find_first_of("/"); 
-        mod_str1 = break_str.substr (0, slash1);
-        mod_str2 = break_str.substr (slash1 + 1, 
-                (break_str.length() - mod_str1.length()));
-    }
-    else { 
-        model_utc2 >> mod_str1 >> mod_str2 >> mod_str3 >> mod_str4;
-    }
-    int len1 = mod_str1.length();
-    int len2 = mod_str2.length();
-    int len3 = mod_str3.length();
-    int len4 = mod_str4.length();   
-    model_year = mod_str2.substr (len2 - 5, 4);
-    int_year = std::stoi( model_year );
-    if (len2 == 7) {
-        model_month = mod_str2.substr (0,1);
-        int_month = std::stoi( model_month );
+bool Force_drag_nrlmsise00::select_exponential_tier() {
+    // NRLMSISE-00 up to msis_ceiling, with exponential decay function above.
+    // ...The tier only changes once the altitude is hysteresis past the 
+    // ...ceiling, so an orbit grazing it does not flip every step
+    if (exponential_tier) {
+        exponential_tier = state->geodetic.alt > msis_ceiling - hysteresis;
     }
     else {
-        model_month = mod_str2.substr (0,2);
-        int_month = std::stoi( model_month );
+        exponential_tier = state->geodetic.alt > msis_ceiling + hysteresis;
     }
-    if (len1 == 2) {
-        model_day = mod_str1.substr (0,1);
-        int_day = std::stoi( model_day );
+    if (exponential_tier) {
+        ++tier_count.exponential;
     }
     else {
-        model_day = mod_str1.substr (0,2);
-        int_day = std::stoi( model_day );
-    };
-    unsigned first = mod_str3.find_first_of(":");
-    unsigned last = mod_str3.find_last_of(":");
-    model_hour = mod_str3.substr(0,first);
-    model_minute = mod_str3.substr (first + 1,last-first - 1);
-    model_second = mod_str3.substr (last + 1,6);
-    int int_hour = std::stoi( model_hour );
-    int int_minute = std::stoi( model_minute );
-    int int_sec = std::stoi( model_second ) + (int_minute * 60) 
-            + (int_hour * 3600);
-    model_second = std::to_string(int_sec);
+        ++tier_count.msis;
+    }
+    return exponential_tier;
+}
 
-    auto [dayyear, previous_day, f10year]
-            = leap_year_doy(int_year, int_month, int_day); 
-    
-    stream_sec << model_second;
-    stream_sec >> model_second;
-    stream_day << model_day;
-    stream_day >> model_day;
-    stream_month << model_month;
-    stream_month >> model_month;
-    stream_year << model_year;
-    stream_year >> model_year; 
-    
-    return {str_dayyear, str_previous_day, str_f10year, model_second, model_day, 
-            model_month, model_year};
 
-};
+void Force_drag_nrlmsise00::apply_density(double rho) {
+    // Drag acceleration and errors for the density at this evaluation. It 
+    // ...may be an intermediate stage or a rejected step, so the step hint
+    // ...only takes it if end_step() follows.
+    apply_drag_density(*state, minus500C_dAm, rho, last_inputs, error_log, 
+            a_ecef);
+    latest_alt = state->geodetic.alt;
+    latest_rho = rho;
+    latest_drag = std::fabs(minus500C_dAm * rho) * state->ecef_v 
+            * state->ecef_v;
+    evaluated = true;
+}
 
-std::tuple<std::string, std::string, 
-        std::string> Force_drag_nrlmsise00::leap_year_doy(int int_year, 
-        int int_month, int int_day) {
-    // Checks if leap year and returns year date and month
 
-    //std::string str_dayyear, str_previous_day, str_f10year;
-    std::stringstream stream_dayyear, stream_previous_day, stream_f10year;
-    int int_dayyear, int_previous_day, int_f10year;
+void Force_drag_nrlmsise00::end_step() {
+    // Called by the integrator once per accepted step, after its last drag 
+    // ...evaluation, which the step hint is then updated from
+    if (evaluated) {
+        update_step_hint(latest_alt, latest_rho, latest_drag);
+        evaluated = false;
+    }
+}
 
-    // Cummulative days in standard / leap years and list of leap years
-    std::map<int, int> cal_days = {{1,0,}, {2,31,}, {3,59,}, {4,90,}, {5,120,}, 
-            {6,151,}, {7,181,}, {8,212,}, {9,243,}, {10,273,}, {11,304,}};
-    std::map<int, int> leap_days = {{1,0,}, {2,31,}, {3,60,}, {4,91,}, {5,121,}, 
-            {6,152,}, {7,182,}, {8,213,}, {9,244,}, {10,274,}, {11,305,}};
-    std::vector<int> leap_yrs = { 1992, 2996, 2000, 2004, 2008, 2012, 2016, 
-            2020 };
-
-    // Checks if leap year and day of year
-    std::map<int,int>::iterator it1;
-    std::map<int,int>::iterator it2;
-    if (std::find(leap_yrs.begin(), leap_yrs.end(), 
-            int_year) == leap_yrs.end()) {
-        // Look up month in cal_days then add day of month for day of year
-        it1 = cal_days.find(int_month);
-        if (it1 != cal_days.end()) {
-            int_dayyear = it1->second + int_day;
-            if(int_dayyear > 1) {
-                int_f10year = int_year;
-                int_previous_day = int_dayyear - 1;
-            }
-            else {
-                int_f10year = int_year - 1;
-                int_previous_day = 365;
+
+void Force_drag_nrlmsise00::set_msis_ceiling(double altitude, 
+        double band) {
+    // Altitude in km above which the exponential model replaces 
+    // ...NRLMSISE-00, and the hysteresis band either side of it
+    msis_ceiling = altitude;
+    hysteresis = band;
+}
+
+
+const Drag_tier_counts &Force_drag_nrlmsise00::tier_counts() const {
+    // Number of evaluations served by each density model
+    return tier_count;
+}
+
+
+void Force_drag_nrlmsise00::update_step_hint(double alt, double rho, 
+        double drag) {
+    // Scale height from this and the previous evaluation when they are far
+    // ...enough apart in altitude to give one, else from the exponential 
+    // ...atmosphere table. Density also changes with time and position, so 
+    // ...implausible values fall back to the table as well.
+    hint.scale_height = Exponential_atmosphere::scale_height(alt);
+    hint.relative_change = 0.0;
+    hint.has_history = previous_drag > 0.0;
+    if (hint.has_history) {
+        double dh = alt - previous_alt;
+        double ratio = rho / previous_rho;
+        if (std::fabs(dh) > 0.01 && ratio > 0.0 && ratio != 1.0) {
+            double scale_height = -dh / std::log(ratio);
+            if (scale_height > 1.0 && scale_height < 2000.0) {
+                hint.scale_height = scale_height;
             }
-            std::string str_dayyear = std::to_string(int_dayyear);
-            std::string str_previous_day = std::to_string(int_previous_day);
-            std::string str_f10year = std::to_string(int_f10year);
-        }
-        else {
-            std::cout << "Month not found in cal_days.";
-            abort();
         }
+        hint.relative_change = std::fabs(drag - previous_drag) 
+                / previous_drag;
     }
-    else {
-        // Look up month in leap_days then add the day of month to get 
-        // ...day of year (int_dayyear) and previous day (int_previous_day)
-        it2 = leap_days.find(int_month);
-        if (it2 != leap_days.end()) {
-            int_dayyear = it2->second + int_day;
-            if(int_dayyear > 1) {
-                int_f10year = int_year;
-                int_previous_day = int_dayyear - 1;
-            }
-            else {
-                int_f10year = int_year - 1;
-                int_previous_day = 366;
-            }
-            std::string str_dayyear = std::to_string(int_dayyear);
-            std::string str_previous_day = std::to_string(int_previous_day);
-            std::string str_f10year = std::to_string(int_f10year);
-        }
-        else {
-            std::cout << "Month not found in leap_days.";
-            abort();
-        }
+    previous_alt = alt;
+    previous_rho = rho;
+    previous_drag = drag;
+}
+
+
+const Drag_step_hint &Force_drag_nrlmsise00::step_hint() const {
+    // Density scale height and how fast drag is changing, see 
+    // ...suggested_step
+    return hint;
+}
+
+
+double Force_drag_nrlmsise00::suggested_step(double step, 
+        double tolerance) const {
+    // Step scaled so drag changes by about tolerance (relative) between 
+    // ...accepted steps, by at most a factor of two either way per call: 
+    // ...large steps at high altitude, short ones near perigee or in a 
+    // ...storm. Unchanged until two steps have been accepted.
+    if (!hint.has_history) {
+        return step;
     }
-    
-    stream_dayyear << str_dayyear;
-    stream_dayyear >> str_dayyear;
-    stream_previous_day << str_previous_day;
-    stream_previous_day >> str_previous_day;
-    stream_f10year << str_f10year;
-    stream_f10year >> str_f10year; 
+    if (hint.relative_change <= 0.0) {
+        return 2.0 * step;
+    }
+    double factor = tolerance / hint.relative_change;
+    return step * std::min(std::max(factor, 0.5), 2.0);
+}
 
-    return {str_dayyear, str_previous_day, str_f10year};
 
-};
+void Force_drag_nrlmsise00::report_errors() {
+    // Adds how often each recorded error recurred to state->errors, after 
+    // ...the first occurrences already there, then clears the record
+    error_log.format_repeats(state->errors);
+    error_log.clear();
+}
 
 
-std::tuple<std::string, std::string> Force_drag_nrlmsise00::msis_f107(
-        std::string prev_day, std::string f10_year) {
-    // Retrieves F10.7 & F10.7A solar flux index values from file:
+void Force_drag_nrlmsise00::latency_summary(std::ostream &out) {
+    // p50/p99/p99.9/max of compute_acceleration for the run summary
+    drag_latency().summary(out);
+}
 
-    std::string F107_value, F107A_value, ignore1, ignore2, ignore3, search, 
-        line;
-    std::stringstream line_stream;
-    std::ifstream inFileF107;
 
-    inFileF107.open("/Users/johnkeeling/Desktop/Astrophysics_MSc/PHAS0062"
-            "_research_project/hawke_files/msis-model_c/DATA/SOLFSMY.TXT");
+void Force_drag_nrlmsise00::use_time_slices(
+        std::shared_ptr<Density_time_slice_service> service) {
+    // Catalog mode: densities are interpolated from a field per epoch shared
+    // ...with the other objects, nullptr to evaluate the model directly
+    time_slices = std::move(service);
+    current_slice.reset();
+}
+
 
-    if (prev_day.length() == 3) {
-        search = f10_year + " " + prev_day; 
+void Force_drag_nrlmsise00::set_speculation(int depth, double tolerance) {
+    // Latency mode for a single satellite: a helper thread evaluates the 
+    // ...model at the next depth guessed positions, and a guess within 
+    // ...tolerance km is used in place of a direct evaluation. 0 turns it off.
+    speculator.reset();
+    if (depth > 0) {
+        speculator = std::make_unique<Density_speculator>(
+                [](const Msis_inputs &guess) {
+                    Msis_inputs inputs = guess;
+                    std::tie(inputs.alt, inputs.lat, inputs.lon) 
+                            = msis_lla_coordinates(guess.alt, guess.lat, 
+                            guess.lon);
+                    return nrlmsise00_run(inputs, nrlmsise00_model_dir());
+                }, depth, tolerance);
     }
-    else if (prev_day.length() == 2) {
-        search = f10_year + "  " + prev_day; 
+}
+
+
+Drag_speculation_counts Force_drag_nrlmsise00::speculation_counts() const {
+    // Hits, misses and helper evaluations; the hit rate is hits over hits 
+    // ...plus misses
+    return speculator != nullptr ? speculator->counts() 
+            : Drag_speculation_counts();
+}
+
+
+double Force_drag_nrlmsise00::slice_density(const Msis_inputs &inputs) {
+    // The slice is kept between calls so the service is only asked when 
+    // ...the epoch changes. NaN outside the grid, for a direct evaluation.
+    if (current_slice == nullptr || !current_slice->same_epoch(inputs)) {
+        current_slice = time_slices->slice(inputs);
     }
-    else {
-        search = f10_year + "   " + prev_day;
+    return current_slice->density(inputs.alt, inputs.lat, inputs.lon);
+}
+
+
+const Drag_stage_stats &Force_drag_nrlmsise00::stats() const {
+    // Per-stage counters of nrlmsise00_density, zero unless built with 
+    // ...FORCE_DRAG_STAGE_STATS
+    return stage_stats;
+}
+
+
+std::vector<std::string> Force_drag_nrlmsise00::msis_index_files() {
+    // F10.7 and Ap files in use, for caches that must notice when they change
+    return {msis_f107_file(), msis_ap_file()};
+}
+
+
+Msis_inputs Force_drag_nrlmsise00::msis_inputs(const std::string &epoch, 
+        double alt, double lat, double lon) {
+    // Model inputs for a time and location, without a force model instance,
+    // ...for the atmosphere policies of Force_drag_atmosphere
+
+    Msis_inputs inputs;
+    auto [altitude, latitude, longitude] = msis_lla_coordinates(alt, lat, 
+            lon);
+    auto [day_of_year, previous_day, f10_year, second, day, month, year] 
+            = msis_time_stamp(epoch);
+    inputs.second = second;
+    inputs.alt = altitude;
+    inputs.lat = latitude;
+    inputs.lon = longitude;
+    msis_space_weather(year, month, day, inputs);
+    return inputs;
+}
+
+
+void Force_drag_nrlmsise00::msis_space_weather(int year, int month, int day,
+        Msis_inputs &inputs) {
+    // Fills in the date and the F10.7, F10.7A and Ap indices for it
+
+    auto [day_of_year, previous_day, f10_year] 
+            = leap_year_doy(year, month, day);
+    auto [F107_value, F107A_value] = msis_f107(previous_day, f10_year);
+    inputs.year = year;
+    inputs.day_of_year = day_of_year;
+    inputs.f107 = F107_value;
+    inputs.f107a = F107A_value;
+    inputs.ap = ap_value(year, month, day);
+}
+
+
+Msis_inputs Force_drag_nrlmsise00::msis_point_inputs(double alt, 
+        double lat, double lon) {
+    // Model inputs for a location at the current epoch, each stage timed 
+    // ...into stage_stats
+
+    DRAG_STAGE_START(coordinates);
+    auto [altitude, latitude, longitude] = msis_lla_coordinates(alt, lat, 
+            lon);
+    DRAG_STAGE_STOP(coordinates);
+    DRAG_STAGE_START(time_stamp);
+    auto [day_of_year, previous_day, f10_year, second, day, month, year] 
+            = msis_time_stamp(state->eci.epoch.str_UTC_datestamp());
+    DRAG_STAGE_STOP(time_stamp);
+    DRAG_STAGE_START(f107);
+    auto [F107_value, F107A_value] 
+            = msis_f107(previous_day, f10_year);
+    DRAG_STAGE_STOP(f107);
+    DRAG_STAGE_START(ap);
+    double Ap_value = ap_value(year, month, day);
+    DRAG_STAGE_STOP(ap);
+    Msis_inputs inputs;
+    inputs.year = year;
+    inputs.day_of_year = day_of_year;
+    inputs.second = second;
+    inputs.alt = altitude;
+    inputs.lat = latitude;
+    inputs.lon = longitude;
+    inputs.f107 = F107_value;
+    inputs.f107a = F107A_value;
+    inputs.ap = Ap_value;
+    return inputs;
+}
+
+
+double Force_drag_nrlmsise00::nrlmsise00_density(double alt, double lat, 
+        double lon) {
+    // Retrieves mass density from atmos. model for given time and location
+
+    Msis_inputs inputs = msis_point_inputs(alt, lat, lon);
+    DRAG_STAGE_START(model);
+    double rho = time_slices != nullptr ? slice_density(inputs) 
+            : std::nan("");
+    if (std::isnan(rho) && speculator != nullptr) {
+        rho = speculator->take(inputs, hint.scale_height);
     }
-    if(!inFileF107){
-    std::cout << "Unable to open file" << std::endl;
-    exit(1);
-    }
-    int pos;
-    while(inFileF107.good()) {
-        getline(inFileF107,line);
-        pos=line.find(search);
-        if(pos!=std::string::npos) {
-                line_stream << line;
-                line_stream >> ignore1 >> ignore2 >> ignore3 >> F107_value 
-                    >> F107A_value;
-            }     
-    }
-    return {F107_value, F107A_value};
+    if (std::isnan(rho)) {
+        rho = retrieve_mass_density(inputs);
+    }
+    if (speculator != nullptr) {
+        speculator->observe(inputs);
+    }
+    DRAG_STAGE_STOP(model);
+    last_inputs = inputs;
+    if (Density_capture *capture = drag_capture()) {
+        capture->append(inputs, rho);
+    }
+
+    return rho;
+
 };
 
+std::tuple<double, double, 
+        double> Force_drag_nrlmsise00::msis_lla_coordinates(double alt, 
+        double lat, double lon) {
+    // Retrieves latitude, longitude and altitude coordinates, as the model 
+    // ...has always been given them: fixed-point text cut to 8 characters
 
-std::string Force_drag_nrlmsise00::ap_value(std::string model_year, 
-        std::string model_month, 
-        std::string model_day) {
-    // Retrieve AP geomagnetic index value from file:
+    return {msis_truncate(alt), msis_truncate(lat), msis_truncate(lon)};
+};
 
-    std::string Ap_value, str_ap_date, Ap1, Ap2, Ap3, Ap4, Ap5, 
-            Ap6, Ap7, Ap8, line_stream1, line;
-    std::ifstream inFileAp;
 
-    inFileAp.open("/Users/johnkeeling/Desktop/Astrophysics_MSc/"
-            "PHAS0062_research_project/hawke_files/msis-model_c/DATA/apindex");
+std::tuple<int, int, int, int, int, int, 
+        int> Force_drag_nrlmsise00::msis_time_stamp(const std::string &epoch) {
+    // Retrieves time stamp for MSIS model from the UTC datestamp
 
-    // Create search string (yymmdd):
-    if (model_month.length() == 1) {
-        if(model_day.length() == 1) {
-            str_ap_date = model_year.substr(2,2) + "0" 
-                    + model_month + "0" + model_day;
+    // Day, month, year, hour, minute and whole seconds are the first six 
+    // ...numbers in the datestamp, whatever separates them
+    int fields[6] = {0, 0, 0, 0, 0, 0};
+    int count = 0;
+    const char *c = epoch.c_str();
+    while (*c != '\0' && count < 6) {
+        if (*c >= '0' && *c <= '9') {
+            int value = 0;
+            while (*c >= '0' && *c <= '9') {
+                value = value * 10 + (*c - '0');
+                ++c;
+            }
+            fields[count++] = value;
         }
         else {
-            str_ap_date = model_year.substr(2,2) + "0" 
-                    + model_month + model_day;
+            ++c;
         }
     }
+    int int_day = fields[0];
+    int int_month = fields[1];
+    int int_year = fields[2];
+    int int_sec = fields[5] + (fields[4] * 60) + (fields[3] * 3600);
+
+    auto [dayyear, previous_day, f10year]
+            = leap_year_doy(int_year, int_month, int_day); 
+
+    return {dayyear, previous_day, f10year, int_sec, int_day, int_month, 
+            int_year};
+
+};
+
+std::tuple<int, int, int> Force_drag_nrlmsise00::leap_year_doy(int int_year, 
+        int int_month, int int_day) {
+    // Checks if leap year and returns day of year, previous day and the 
+    // ...year of the previous day
+
+    int int_dayyear, int_previous_day, int_f10year;
+
+    // Cummulative days before each month in standard / leap years
+    static const int cal_days[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 
+            273, 304, 334};
+    static const int leap_days[12] = {0, 31, 60, 91, 121, 152, 182, 213, 244, 
+            274, 305, 335};
+
+    // A bad month is clamped and reported, never stops the propagation
+    if (int_month < 1 || int_month > 12) {
+        Drag_log::instance().write(Drag_log_id::month_out_of_range, 
+                "Force_drag: Month %d not found in cal_days.", int_month);
+        int_month = std::min(std::max(int_month, 1), 12);
+    }
+    // Look up month then add day of month for day of year
+    if (is_leap_year(int_year)) {
+        int_dayyear = leap_days[int_month - 1] + int_day;
+    }
     else {
-        if(model_day.length() == 1) {
-            str_ap_date = model_year.substr(2,2) 
-                    + model_month + "0" + model_day;
-        }
-        else {
-            str_ap_date = model_year.substr(2,2) + model_month + model_day;
-        }
+        int_dayyear = cal_days[int_month - 1] + int_day;
     }
-    while(getline(inFileAp, line)) {
-        if (line.find(str_ap_date, 0) != std::string::npos) {
-            if (line.substr (0,6) == str_ap_date) {
-                line_stream1 = line.substr (31,24);
-            }
-        }
+    if (int_dayyear > 1) {
+        int_f10year = int_year;
+        int_previous_day = int_dayyear - 1;
+    }
+    else {
+        int_f10year = int_year - 1;
+        int_previous_day = is_leap_year(int_f10year) ? 366 : 365;
     }
-    // Find average AP value
-    Ap1 = line_stream1.substr (0,3);
-    Ap2 = line_stream1.substr (3,3);
-    Ap3 = line_stream1.substr (6,3);
-    Ap4 = line_stream1.substr (9,3);
-    Ap5 = line_stream1.substr (12,3);
-    Ap6 = line_stream1.substr (15,3);
-    Ap7 = line_stream1.substr (18,3);
-    Ap8 = line_stream1.substr (21,3);
-    int int1 = std::stoi(Ap1);
-    int int2 = std::stoi(Ap2);
-    int int3 = std::stoi(Ap3);
-    int int4 = std::stoi(Ap4);
-    int int5 = std::stoi(Ap5);
-    int int6 = std::stoi(Ap6);
-    int int7 = std::stoi(Ap7);
-    int int8 = std::stoi(Ap8);
-    int int_Ap = round(float(int1 + int2 + int3 + int4 + int5 
-            + int6 + int7 + int8) / 8);
-    Ap_value = std::to_string(int_Ap);
-
-    return Ap_value;
+
+    return {int_dayyear, int_previous_day, int_f10year};
+
 };
 
-    
-double Force_drag_nrlmsise00::retrieve_mass_density(std::string str_dayyear, 
-        std::string model_year, std::string model_second, 
-        std::string model_altitude, std::string model_latitude, 
-        std::string model_longitude, std::string F107_value,
-        std::string F107A_value, std::string Ap_value) {
-    //Command line instructions to run NRLMSISE00:
-
-    std::string str_start, str_end, str_res, str_convert;
-
-    std::string cmd = std::string("/Users/johnkeeling/Desktop/Astrophysics_MSc/"
-            "PHAS0062_research_project/hawke_files/MSIS-model_c/nrlmsise_test01") 
-            + std::string(" " + str_dayyear + " "  + model_year + " " 
-            + model_second + "  " + model_altitude + "  " + model_latitude 
-            + "  " + model_longitude + "  " + "0" + "  " + F107_value + "  " 
-            + F107A_value + "  " + Ap_value);
-    chdir("/Users/johnkeeling/Desktop/Astrophysics_MSc/"
-            "PHAS0062_research_project/hawke_files/MSIS-model_c");  
-    FILE *command=popen(cmd.c_str(), "r");
-    char result[24]={0x0};
-    while (fgets(result, sizeof(result), command) !=NULL)
-    pclose(command);
-    chdir("/Users/johnkeeling/Desktop/Astrophysics_MSc/"
-            "PHAS0062_research_project/hawke_files/odl20lite/bin");
-
-    //Reformat density value to make it C++ compatible
-    str_res = result;
-    double rho;
-    if (str_res == "inf" || str_res.substr(8,1) != "e") {
-        rho = 1.000E-13;
-        std::cout << "1.0E-16 substituted for infinite density value "
-                "returned by nrlmsise." << std::endl;
+
+std::tuple<double, double> Force_drag_nrlmsise00::msis_f107(int prev_day, 
+        int f10_year) {
+    // Retrieves F10.7 & F10.7A solar flux index values, from the table read
+    // ...from file at setup
+
+    const std::vector<F107_entry> &table = f107_table();
+    auto it = std::lower_bound(table.begin(), table.end(), 
+            std::make_pair(f10_year, prev_day), 
+            [](const F107_entry &entry, const std::pair<int, int> &key) {
+                return std::make_pair(entry.year, entry.day_of_year) < key;
+            });
+    if (it == table.end() || it->year != f10_year 
+            || it->day_of_year != prev_day) {
+        Drag_log::instance().write(Drag_log_id::index_date_missing, 
+                "Force_drag: No F10.7 for %d day %d.", f10_year, prev_day);
+        return {std::nan(""), std::nan("")};
     }
-    else {
-        unsigned slash2 = str_res.find_first_of("e"); 
-        str_start = str_res.substr(0, slash2);
-        str_end = str_res.substr(slash2 + 1, 3);
-        //Conversion from gm/cm-3 to kg/m-3:
-        int int_convert = std::stoi(str_end) + 3;
-        str_convert = std::to_string(int_convert);
-        str_res = str_start + "E" + str_convert;
-        rho = std::stod(str_res); 
+    return {it->f107, it->f107a};
+};
+
+
+double Force_drag_nrlmsise00::ap_value(int model_year, int model_month, 
+        int model_day) {
+    // Retrieve daily average AP geomagnetic index value, from the table read
+    // ...from file at setup
+
+    // apindex lines are keyed by date as yymmdd
+    int ap_date = (model_year % 100) * 10000 + model_month * 100 + model_day;
+    const std::vector<Ap_entry> &table = ap_table();
+    auto it = std::upper_bound(table.begin(), table.end(), ap_date, 
+            [](int date, const Ap_entry &entry) {
+                return date < entry.date;
+            });
+    if (it == table.begin() || (it - 1)->date != ap_date) {
+        Drag_log::instance().write(Drag_log_id::index_date_missing, 
+                "Force_drag: No Ap for %06d.", ap_date);
+        return std::nan("");
     }
-    return rho;
+    return (it - 1)->ap;
+};
+
+    
+double Force_drag_nrlmsise00::retrieve_mass_density(
+        const Msis_inputs &inputs) {
+    // Runs NRLMSISE00 for the prepared inputs
+
+    return nrlmsise00_run(inputs, nrlmsise00_model_dir());
 };
@@ -0,0 +1,50 @@
+/*! @file Force_drag_stats.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Counters reported by the nrlmsise00 drag force model
+ */
+
+#ifndef FORCE_DRAG_STATS_H
+#define FORCE_DRAG_STATS_H
+
+#include <cstdint>
+
+// Counters for one stage of nrlmsise00_density, filled in when built with
+// ...FORCE_DRAG_STAGE_STATS, otherwise left at zero
+struct Drag_stage_counter {
+    std::uint64_t calls = 0;
+    std::uint64_t cycles = 0;       // cumulative TSC cycles over all calls
+    std::uint64_t max_cycles = 0;   // slowest single call
+};
+
+struct Drag_stage_stats {
+    Drag_stage_counter coordinates;   // msis_lla_coordinates
+    Drag_stage_counter time_stamp;    // msis_time_stamp and leap_year_doy
+    Drag_stage_counter f107;          // msis_f107 index lookup
+    Drag_stage_counter ap;            // ap_value index lookup
+    Drag_stage_counter model;         // retrieve_mass_density
+};
+
+// Evaluations served by each tier of the adaptive density model
+struct Drag_tier_counts {
+    std::uint64_t msis = 0;
+    std::uint64_t exponential = 0;
+};
+
+// Step size hint from the drag model, for the integrator's step controller.
+// ...Updated by Force_drag_nrlmsise00::end_step, once per accepted step.
+struct Drag_step_hint {
+    double scale_height = 0.0;      // km, local density scale height
+    double relative_change = 0.0;   // |change in drag| / |drag| since the 
+                                    // ...previous accepted step
+    bool has_history = false;       // relative_change spans two steps
+};
+
+// Look-ahead evaluations, see Force_drag_nrlmsise00::set_speculation
+struct Drag_speculation_counts {
+    std::uint64_t hits = 0;         // evaluations served by a guess
+    std::uint64_t misses = 0;       // evaluated directly, no guess close
+    std::uint64_t evaluations = 0;  // guesses evaluated by the helper
+};
+
+#endif
@@ -0,0 +1,140 @@
+/*! @file Latency_histogram.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Per-thread log-bucketed latency histograms with percentile summary
+ */
+
+#include "Latency_histogram.h"
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+Latency_histogram::Latency_histogram() : max_ns(0) {
+    for (auto &count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void Latency_histogram::record(std::uint64_t ns) {
+    // Single writer, so a relaxed load and store is enough, no locked add
+    std::atomic<std::uint64_t> &count = counts[bucket_index(ns)];
+    count.store(count.load(std::memory_order_relaxed) + 1, 
+            std::memory_order_relaxed);
+    if (ns > max_ns.load(std::memory_order_relaxed)) {
+        max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+
+void Latency_histogram::add_to(std::array<std::uint64_t, bucket_count> &totals,
+        std::uint64_t &max_value) const {
+    for (int i = 0; i < bucket_count; ++i) {
+        totals[i] += counts[i].load(std::memory_order_relaxed);
+    }
+    std::uint64_t local_max = max_ns.load(std::memory_order_relaxed);
+    if (local_max > max_value) {
+        max_value = local_max;
+    }
+}
+
+
+int Latency_histogram::bucket_index(std::uint64_t ns) {
+    if (ns < static_cast<std::uint64_t>(exact_buckets)) {
+        return static_cast<int>(ns);
+    }
+    // Keep the top sub_bucket_bits of the value, shift counts the rest
+    int bit_width = 64 - __builtin_clzll(ns);
+    int shift = bit_width - sub_bucket_bits;
+    int top = static_cast<int>(ns >> shift);
+    return exact_buckets + (shift - 1) * group_buckets 
+            + (top - group_buckets);
+}
+
+
+std::uint64_t Latency_histogram::bucket_upper(int index) {
+    // Largest value that falls in the bucket
+    if (index < exact_buckets) {
+        return static_cast<std::uint64_t>(index);
+    }
+    int shift = (index - exact_buckets) / group_buckets + 1;
+    std::uint64_t top = (index - exact_buckets) % group_buckets 
+            + group_buckets;
+    return ((top + 1) << shift) - 1;
+}
+
+
+Latency_recorder::Latency_recorder(std::string in_name) 
+        : name(std::move(in_name)) {
+    static std::atomic<std::uint64_t> next_id(1);
+    id = next_id.fetch_add(1);
+}
+
+
+Latency_histogram &Latency_recorder::local() {
+    // Recorders are told apart by id, not address, so a recorder created 
+    // ...where an old one lived never picks up the old thread's histogram
+    thread_local std::vector<std::pair<std::uint64_t, 
+            Latency_histogram *>> owned;
+    for (auto &entry : owned) {
+        if (entry.first == id) {
+            return *entry.second;
+        }
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    histograms.push_back(std::make_unique<Latency_histogram>());
+    owned.emplace_back(id, histograms.back().get());
+    return *histograms.back();
+}
+
+
+void Latency_recorder::record(std::uint64_t ns) {
+    local().record(ns);
+}
+
+
+Latency_summary Latency_recorder::summarize() const {
+    // Merges every thread's histogram and reads off the percentiles
+    std::array<std::uint64_t, Latency_histogram::bucket_count> totals{};
+    Latency_summary result;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto &histogram : histograms) {
+            histogram->add_to(totals, result.max);
+        }
+    }
+    for (std::uint64_t count : totals) {
+        result.count += count;
+    }
+    if (result.count == 0) {
+        return result;
+    }
+
+    const double quantiles[3] = {0.50, 0.99, 0.999};
+    std::uint64_t *targets[3] = {&result.p50, &result.p99, &result.p999};
+    std::uint64_t seen = 0;
+    int next = 0;
+    for (int i = 0; i < Latency_histogram::bucket_count && next < 3; ++i) {
+        seen += totals[i];
+        while (next < 3 && seen >= quantiles[next] * result.count) {
+            std::uint64_t upper = Latency_histogram::bucket_upper(i);
+            *targets[next] = upper < result.max ? upper : result.max;
+            ++next;
+        }
+    }
+    return result;
+}
+
+
+void Latency_recorder::summary(std::ostream &out) const {
+    // One line for the run summary, in microseconds. Formatted locally so
+    // ...the caller's stream keeps its own flags and precision.
+    Latency_summary result = summarize();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << name << " latency (us): n = " 
+        << result.count << ", p50 = " << result.p50 / 1000.0 
+        << ", p99 = " << result.p99 / 1000.0 
+        << ", p99.9 = " << result.p999 / 1000.0 
+        << ", max = " << result.max / 1000.0;
+    out << line.str() << std::endl;
+}
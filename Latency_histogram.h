@@ -0,0 +1,75 @@
+/*! @file Latency_histogram.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Per-thread log-bucketed latency histograms with percentile summary
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Percentiles of a merged histogram, all in nanoseconds
+struct Latency_summary {
+    std::uint64_t count = 0;
+    std::uint64_t p50 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+    std::uint64_t max = 0;
+};
+
+// HDR-style histogram: values below 64 ns are exact, above that each power 
+// ...of two is split into 32 buckets, so any value is held to within 3%. 
+// ...Written by one thread only, read by any thread at the end of a run.
+class Latency_histogram {
+public:
+    static constexpr int sub_bucket_bits = 6;
+    static constexpr int exact_buckets = 1 << sub_bucket_bits;
+    static constexpr int group_buckets = exact_buckets / 2;
+    static constexpr int bucket_count = exact_buckets 
+            + (64 - sub_bucket_bits) * group_buckets;
+
+    Latency_histogram();
+    Latency_histogram(const Latency_histogram &) = delete;
+    Latency_histogram &operator=(const Latency_histogram &) = delete;
+
+    void record(std::uint64_t ns);
+    void add_to(std::array<std::uint64_t, bucket_count> &totals, 
+            std::uint64_t &max_ns) const;
+
+    static int bucket_index(std::uint64_t ns);
+    static std::uint64_t bucket_upper(int index);
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> counts;
+    std::atomic<std::uint64_t> max_ns;
+};
+
+// Named set of per-thread histograms. Each thread records into its own 
+// ...histogram without locking, the mutex is only taken the first time a 
+// ...thread records and when the histograms are merged.
+class Latency_recorder {
+public:
+    explicit Latency_recorder(std::string in_name);
+
+    void record(std::uint64_t ns);
+    Latency_summary summarize() const;
+    void summary(std::ostream &out) const;
+
+private:
+    Latency_histogram &local();
+
+    std::string name;
+    std::uint64_t id;
+    mutable std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Latency_histogram>> histograms;
+};
+
+#endif
@@ -0,0 +1,23 @@
+/*! @file Msis_inputs.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Numeric inputs of one NRLMSISE-00 density evaluation
+ */
+
+#ifndef MSIS_INPUTS_H
+#define MSIS_INPUTS_H
+
+// Everything the model is given for one point, in the units it expects
+struct Msis_inputs {
+    int year = 0;
+    int day_of_year = 0;
+    double second = 0.0;    // UT seconds of the day
+    double alt = 0.0;       // km
+    double lat = 0.0;       // deg
+    double lon = 0.0;       // deg
+    double f107 = 0.0;      // previous day F10.7
+    double f107a = 0.0;     // 81 day average F10.7
+    double ap = 0.0;        // daily Ap
+};
+
+#endif
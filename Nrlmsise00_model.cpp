@@ -0,0 +1,150 @@
+/*! @file Nrlmsise00_model.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Runs the external NRLMSISE-00 executable
+ */
+
+#include "Nrlmsise00_model.h"
+#include "Drag_log.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Density in kg/m3 given for a point the model could not evaluate
+const double substitute_density = 1.000E-13;
+
+// The model process, or NULL, logged, if it should not or could not be run
+FILE *nrlmsise00_start(const Msis_inputs &inputs, 
+        const std::string &model_dir) {
+    // A missing index is NaN; no process is started for a point that 
+    // ...cannot give a density
+    if (!std::isfinite(inputs.second) || !std::isfinite(inputs.alt) 
+            || !std::isfinite(inputs.lat) || !std::isfinite(inputs.lon) 
+            || !std::isfinite(inputs.f107) || !std::isfinite(inputs.f107a) 
+            || !std::isfinite(inputs.ap)) {
+        Drag_log::instance().write(Drag_log_id::density_substituted, 
+                "Force_drag: %.1E substituted for non-finite model input, "
+                "%d day %d.", substitute_density, inputs.year, 
+                inputs.day_of_year);
+        return NULL;
+    }
+    char cmd[1024];
+    if (!nrlmsise00_command(inputs, model_dir, cmd, sizeof(cmd))) {
+        Drag_log::instance().write(Drag_log_id::density_substituted, 
+                "Force_drag: Model command for %.64s... does not fit, not "
+                "run.", model_dir.c_str());
+        return NULL;
+    }
+    FILE *command = popen(cmd, "r");
+    if (command == NULL) {
+        Drag_log::instance().write(Drag_log_id::density_substituted, 
+                "Force_drag: %.1E substituted, unable to run nrlmsise.", 
+                substitute_density);
+    }
+    return command;
+}
+
+double nrlmsise00_finish(FILE *command) {
+    if (command == NULL) {
+        return substitute_density;
+    }
+    // Keep the last line printed, then close the pipe once
+    char result[24]={0x0};
+    while (fgets(result, sizeof(result), command) != NULL) {}
+    pclose(command);
+
+    //Reformat density value to make it C++ compatible
+    std::size_t length = std::strlen(result);
+    while (length > 0 && (result[length - 1] == '\n' 
+            || result[length - 1] == '\r' || result[length - 1] == ' ')) {
+        result[--length] = '\0';
+    }
+    double rho;
+    if (std::strcmp(result, "inf") == 0 || length < 9 || result[8] != 'e') {
+        rho = substitute_density;
+        Drag_log::instance().write(Drag_log_id::density_substituted, 
+                "Force_drag: %.1E substituted for invalid density value "
+                "\"%s\" returned by nrlmsise.", rho, result);
+    }
+    else {
+        //Conversion from gm/cm-3 to kg/m-3, by moving the exponent so the 
+        // ...result parses exactly as the printed value would
+        char converted[32];
+        int int_convert = std::atoi(result + 9) + 3;
+        std::snprintf(converted, sizeof(converted), "%.8sE%d", result, 
+                int_convert);
+        rho = std::strtod(converted, NULL); 
+    }
+    return rho;
+}
+
+}
+
+bool nrlmsise00_command(const Msis_inputs &inputs, 
+        const std::string &model_dir, char *cmd, std::size_t size) {
+    //Command line instructions to run NRLMSISE00:
+
+    // Built in a fixed buffer. %.15g is not the old string form, 150.0 is
+    // ...printed as 150, but the model reads the same numbers, and a 
+    // ...replayed Msis_inputs record prints the same line as the run that
+    // ...captured it. The model is run from its own directory by the 
+    // ...shell, rather than by chdir(), as the working directory is shared
+    // ...by every thread. The directory is single quoted, each ' in it 
+    // ...written as '\'', so the shell takes it as one word whatever it 
+    // ...contains.
+    char quoted[512];
+    std::size_t length = 0;
+    quoted[length++] = '\'';
+    for (char c : model_dir) {
+        if (length + 6 > sizeof(quoted)) {
+            return false;
+        }
+        if (c == '\'') {
+            std::memcpy(quoted + length, "'\\''", 4);
+            length += 4;
+        }
+        else {
+            quoted[length++] = c;
+        }
+    }
+    quoted[length++] = '\'';
+    quoted[length] = '\0';
+    int written = std::snprintf(cmd, size, "cd %s && ./nrlmsise_test01 %d "
+            "%d %.15g  %.15g  %.15g  %.15g  0  %.15g  %.15g  %.15g", quoted, 
+            inputs.day_of_year, inputs.year, inputs.second, inputs.alt, 
+            inputs.lat, inputs.lon, inputs.f107, inputs.f107a, inputs.ap);
+    return written >= 0 && static_cast<std::size_t>(written) < size;
+}
+
+
+const std::string &nrlmsise00_model_dir() {
+    static const std::string path = std::getenv("OPS_MSIS_MODEL_DIR") != NULL
+            ? std::string(std::getenv("OPS_MSIS_MODEL_DIR")) 
+            : std::string("/Users/johnkeeling/Desktop/Astrophysics_MSc/"
+            "PHAS0062_research_project/hawke_files/MSIS-model_c");
+    return path;
+}
+
+
+double nrlmsise00_run(const Msis_inputs &inputs, 
+        const std::string &model_dir) {
+    return nrlmsise00_finish(nrlmsise00_start(inputs, model_dir));
+}
+
+
+void nrlmsise00_run_batch(const Msis_inputs *inputs, std::size_t count, 
+        double *rho, const std::string &model_dir) {
+    // Every process is started before any is read, so the points of a batch
+    // ...are evaluated side by side rather than one after another
+    std::vector<FILE *> commands(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        commands[i] = nrlmsise00_start(inputs[i], model_dir);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        rho[i] = nrlmsise00_finish(commands[i]);
+    }
+}
@@ -0,0 +1,32 @@
+/*! @file Nrlmsise00_model.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Runs the external NRLMSISE-00 executable
+ */
+
+#ifndef NRLMSISE00_MODEL_H
+#define NRLMSISE00_MODEL_H
+
+#include "Msis_inputs.h"
+#include <cstddef>
+#include <string>
+
+// Directory holding nrlmsise_test01, from OPS_MSIS_MODEL_DIR if it is set
+const std::string &nrlmsise00_model_dir();
+
+// Shell command running the model for inputs from model_dir, written into
+// ...cmd. False, and nothing should be run, if it does not fit in size.
+bool nrlmsise00_command(const Msis_inputs &inputs, 
+        const std::string &model_dir, char *cmd, std::size_t size);
+
+// Total mass density in kg/m3 from the nrlmsise_test01 executable found in 
+// ...model_dir. 1E-13, and no process run, for non-finite inputs such as a
+// ...missing index.
+double nrlmsise00_run(const Msis_inputs &inputs, const std::string &model_dir);
+
+// Densities of count points into rho, the same as nrlmsise00_run for each 
+// ...but with the model processes for the whole batch running at once
+void nrlmsise00_run_batch(const Msis_inputs *inputs, std::size_t count, 
+        double *rho, const std::string &model_dir);
+
+#endif
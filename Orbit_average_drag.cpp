@@ -0,0 +1,140 @@
+/*! @file Orbit_average_drag.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Orbit-averaged drag on mean elements for long-term lifetime studies
+ */
+
+#include "Orbit_average_drag.h"
+#include "../include/Resident_space_object.h"
+
+namespace {
+
+const double mu = 398600.4418;          // km3/s2
+const double earth_radius = 6378.137;   // km
+
+bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Moves a year, day of year and second of day on by dt seconds
+void advance_epoch(int &year, int &day_of_year, double &second, double dt) {
+    second += dt;
+    while (second >= 86400.0) {
+        second -= 86400.0;
+        if (++day_of_year > (is_leap_year(year) ? 366 : 365)) {
+            day_of_year = 1;
+            ++year;
+        }
+    }
+}
+
+void month_day(int year, int day_of_year, int &month, int &day) {
+    static const int month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 
+            31, 30, 31};
+    month = 1;
+    day = day_of_year;
+    while (month < 12) {
+        int length = month_days[month - 1] 
+                + (month == 2 && is_leap_year(year) ? 1 : 0);
+        if (day <= length) {
+            break;
+        }
+        day -= length;
+        ++month;
+    }
+}
+
+double gmst(int year, int day_of_year, double second) {
+    // Greenwich mean sidereal time in radians, from days since J2000
+    int days = 0;
+    for (int y = 2000; y < year; ++y) {
+        days += is_leap_year(y) ? 366 : 365;
+    }
+    for (int y = year; y < 2000; ++y) {
+        days -= is_leap_year(y) ? 366 : 365;
+    }
+    double d = days + (day_of_year - 1) + second / 86400.0 - 0.5;
+    double degrees = std::fmod(280.46061837 + 360.98564736629 * d, 360.0);
+    return degrees * M_PI / 180.0;
+}
+
+}
+
+std::vector<std::pair<double, double>> eccentric_anomaly_nodes(int count) {
+    // Legendre roots by Newton iteration, then mapped from [-1, 1]
+    std::vector<std::pair<double, double>> nodes;
+    for (int k = 1; k <= count; ++k) {
+        double x = std::cos(M_PI * (k - 0.25) / (count + 0.5));
+        double derivative = 1.0;
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            double p0 = 1.0, p1 = x;
+            for (int j = 2; j <= count; ++j) {
+                double p2 = ((2.0 * j - 1.0) * x * p1 - (j - 1.0) * p0) / j;
+                p0 = p1;
+                p1 = p2;
+            }
+            derivative = count * (x * p1 - p0) / (x * x - 1.0);
+            double dx = p1 / derivative;
+            x -= dx;
+            if (std::fabs(dx) < 1e-15) {
+                break;
+            }
+        }
+        double weight = 2.0 / ((1.0 - x * x) * derivative * derivative);
+        nodes.emplace_back(M_PI * (x + 1.0), M_PI * weight);
+    }
+    return nodes;
+}
+
+
+double orbit_period(const Mean_elements &elements) {
+    return 2.0 * M_PI * std::sqrt(elements.a * elements.a * elements.a / mu);
+}
+
+
+Msis_inputs orbit_point_inputs(const Mean_elements &elements, double E, 
+        bool space_weather) {
+    double e = elements.e;
+    double r = elements.a * (1.0 - e * std::cos(E));
+    double nu = 2.0 * std::atan2(std::sqrt(1.0 + e) * std::sin(0.5 * E), 
+            std::sqrt(1.0 - e) * std::cos(0.5 * E));
+    double u = elements.argp + nu;
+
+    // Time from perigee, to place the point in local time
+    Msis_inputs inputs;
+    int year = elements.year;
+    int day_of_year = elements.day_of_year;
+    double second = elements.second;
+    double mean_motion = 2.0 * M_PI / orbit_period(elements);
+    advance_epoch(year, day_of_year, second, 
+            (E - e * std::sin(E)) / mean_motion);
+
+    double right_ascension = elements.raan + std::atan2(
+            std::cos(elements.i) * std::sin(u), std::cos(u));
+    double lon = std::remainder(right_ascension 
+            - gmst(year, day_of_year, second), 2.0 * M_PI);
+    inputs.alt = r - earth_radius;
+    inputs.lat = std::asin(std::sin(elements.i) * std::sin(u)) * 180.0 / M_PI;
+    inputs.lon = lon * 180.0 / M_PI;
+    inputs.year = year;
+    inputs.day_of_year = day_of_year;
+    inputs.second = std::floor(second);
+    if (space_weather) {
+        int month, day;
+        month_day(year, day_of_year, month, day);
+        Force_drag_nrlmsise00::msis_space_weather(year, month, day, inputs);
+    }
+    return inputs;
+}
+
+
+Mean_elements advance_elements(const Mean_elements &elements, 
+        const Mean_element_rates &rates, double dt) {
+    Mean_elements result = elements;
+    result.a += rates.a * dt;
+    result.e = std::max(0.0, elements.e + rates.e * dt);
+    result.raan += rates.raan * dt;
+    result.argp += rates.argp * dt;
+    advance_epoch(result.year, result.day_of_year, result.second, dt);
+    return result;
+}
@@ -0,0 +1,142 @@
+/*! @file Orbit_average_drag.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Orbit-averaged drag on mean elements for long-term lifetime studies
+ */
+
+#ifndef ORBIT_AVERAGE_DRAG_H
+#define ORBIT_AVERAGE_DRAG_H
+
+#include "Msis_inputs.h"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Mean elements and the calendar epoch they refer to
+struct Mean_elements {
+    double a = 0.0;         // semi-major axis, km
+    double e = 0.0;
+    double i = 0.0;         // inclination, rad
+    double raan = 0.0;      // rad
+    double argp = 0.0;      // argument of perigee, rad
+    int year = 0;
+    int day_of_year = 0;
+    double second = 0.0;    // UT seconds of the day
+};
+
+struct Mean_element_rates {
+    double a = 0.0;         // km/s
+    double e = 0.0;         // 1/s
+    double raan = 0.0;      // rad/s, J2
+    double argp = 0.0;      // rad/s, J2
+};
+
+// Gauss-Legendre nodes and weights mapped onto eccentric anomaly [0, 2 pi]
+std::vector<std::pair<double, double>> eccentric_anomaly_nodes(int count);
+
+// Model inputs at eccentric anomaly E of the orbit, on a spherical Earth. 
+// ...The epoch is moved on by the time from perigee, and the date and 
+// ...indices are filled in when space_weather is set.
+Msis_inputs orbit_point_inputs(const Mean_elements &elements, double E, 
+        bool space_weather);
+
+// Mean elements moved on by dt seconds at constant rates
+Mean_elements advance_elements(const Mean_elements &elements, 
+        const Mean_element_rates &rates, double dt);
+
+double orbit_period(const Mean_elements &elements);
+
+// Drag averaged over each revolution (King-Hele, non-rotating atmosphere, 
+// ...drag along the velocity) with the density sampled at Gauss quadrature 
+// ...nodes in eccentric anomaly, plus J2 precession of the node and perigee 
+// ...so the sampled perigee moves as it should. Uses the same atmosphere 
+// ...policies and index tables as Force_drag_atmosphere.
+template <typename Atmosphere>
+class Orbit_average_drag {
+public:
+    // ballistic is Cd A / m in m2/kg
+    Orbit_average_drag(Atmosphere in_atmosphere, double in_ballistic, 
+            int node_count = 16) 
+            : atmosphere(std::move(in_atmosphere)), ballistic(in_ballistic),
+            nodes(eccentric_anomaly_nodes(node_count)) {}
+
+    Mean_element_rates rates(const Mean_elements &elements) const {
+        const double j2 = 1.08262668e-3;
+        const double earth_radius = 6378.137; // km
+
+        // Change in a (km) and e over one revolution
+        double integral_a = 0.0, integral_e = 0.0;
+        bool space_weather = atmosphere.needs_space_weather();
+        for (const auto &[E, weight] : nodes) {
+            double rho = atmosphere.density(
+                    orbit_point_inputs(elements, E, space_weather));
+            double cos_E = std::cos(E);
+            double plus = 1.0 + elements.e * cos_E;
+            double minus = 1.0 - elements.e * cos_E;
+            integral_a += weight * rho * std::pow(plus, 1.5) 
+                    / std::sqrt(minus);
+            integral_e += weight * rho * std::sqrt(plus / minus) * cos_E;
+        }
+        double delta_a = -ballistic * elements.a * elements.a * integral_a 
+                * 1000.0;
+        double delta_e = -ballistic * elements.a * 1000.0 
+                * (1.0 - elements.e * elements.e) * integral_e;
+
+        Mean_element_rates result;
+        double period = orbit_period(elements);
+        result.a = delta_a / period;
+        result.e = delta_e / period;
+        double n = 2.0 * M_PI / period;
+        double p = elements.a * (1.0 - elements.e * elements.e);
+        double factor = n * j2 * (earth_radius / p) * (earth_radius / p);
+        double cos_i = std::cos(elements.i);
+        result.raan = -1.5 * factor * cos_i;
+        result.argp = 0.75 * factor * (5.0 * cos_i * cos_i - 1.0);
+        return result;
+    }
+
+    Mean_elements step(const Mean_elements &elements, 
+            double revolutions) const {
+        // Midpoint rule over a whole number of revolutions, so the short 
+        // ...periodic drag terms have already been averaged out
+        double dt = revolutions * orbit_period(elements);
+        Mean_elements middle = advance_elements(elements, rates(elements), 
+                0.5 * dt);
+        return advance_elements(elements, rates(middle), dt);
+    }
+
+    // Seconds until perigee falls below reentry_altitude (km), or max_time
+    // ...if it has not by then. final receives the last elements reached.
+    double lifetime(Mean_elements elements, double revolutions_per_step, 
+            double reentry_altitude, double max_time, 
+            Mean_elements *final = nullptr) const {
+        const double earth_radius = 6378.137;
+        double elapsed = 0.0;
+        while (elapsed < max_time && elements.a * (1.0 - elements.e) 
+                - earth_radius > reentry_altitude) {
+            // Fewer revolutions per step as decay speeds up near the end
+            double revolutions = revolutions_per_step;
+            Mean_element_rates now = rates(elements);
+            double period = orbit_period(elements);
+            if (now.a < 0.0) {
+                double revs_to_go = -0.05 * (elements.a * (1.0 - elements.e)
+                        - earth_radius) / (now.a * period);
+                revolutions = std::max(1.0, std::min(revolutions, 
+                        revs_to_go));
+            }
+            elapsed += revolutions * period;
+            elements = step(elements, revolutions);
+        }
+        if (final != nullptr) {
+            *final = elements;
+        }
+        return elapsed;
+    }
+
+private:
+    Atmosphere atmosphere;
+    double ballistic;
+    std::vector<std::pair<double, double>> nodes;
+};
+
+#endif
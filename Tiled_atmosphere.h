@@ -0,0 +1,129 @@
+/*! @file Tiled_atmosphere.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Atmosphere policy interpolating another from cached density tiles
+ */
+
+#ifndef TILED_ATMOSPHERE_H
+#define TILED_ATMOSPHERE_H
+
+#include "Density_tile_cache.h"
+#include "Density_tile_store.h"
+#include "Msis_inputs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Atmosphere policy interpolating another from tiles held in a shared
+// ...Density_tile_cache, for use with Force_drag_atmosphere. Copies share
+// ...the cache. Altitudes outside the grid go to the model directly. With
+// ...a Density_tile_store, tiles missing from the cache are read from disk
+// ...before the model is run, and tiles the model was run for are written.
+template <typename Atmosphere>
+class Tiled_atmosphere {
+public:
+    Tiled_atmosphere(Atmosphere in_model,
+            std::shared_ptr<Density_tile_cache> in_cache,
+            const Density_tile_grid &in_grid = Density_tile_grid(),
+            std::shared_ptr<Density_tile_store> in_store = nullptr)
+            : model(std::move(in_model)), cache(std::move(in_cache)),
+            grid(in_grid), store(std::move(in_store)) {}
+
+    bool needs_space_weather() const { return model.needs_space_weather(); }
+
+    double density(const Msis_inputs &inputs) const {
+        if (!(inputs.alt >= grid.alt_min && inputs.alt <= grid.alt_max)) {
+            return model.density(inputs);
+        }
+        int bucket_count = static_cast<int>(std::ceil(
+                86400.0 / grid.bucket_seconds));
+        int bucket = std::min(static_cast<int>(
+                inputs.second / grid.bucket_seconds), bucket_count - 1);
+        double local_time = std::fmod(inputs.second / 3600.0
+                + inputs.lon / 15.0, 24.0);
+        if (local_time < 0.0) {
+            local_time += 24.0;
+        }
+
+        // Position in grid cells, the cell it falls in, and how far across
+        double a = (inputs.alt - grid.alt_min) / grid.alt_step;
+        double b = (std::min(std::max(inputs.lat, -90.0), 90.0) + 90.0)
+                / grid.lat_step;
+        double c = local_time / grid.local_time_step;
+        int i = std::min(static_cast<int>(a), alt_cells() - 1);
+        int j = std::min(static_cast<int>(b), lat_cells() - 1);
+        int k = std::min(static_cast<int>(c), local_time_cells() - 1);
+        int n = grid.tile_cells;
+
+        Density_tile_key key = {(static_cast<std::int64_t>(inputs.year)
+                * 366 + inputs.day_of_year) * bucket_count + bucket,
+                i / n, j / n, k / n};
+        Density_tile_cache::Tile_ptr tile = cache->find_or_build(key,
+                [&]() { return build(inputs, bucket, key); });
+        int edge = n + 1;
+        double rho = tile_interpolate(tile->data()
+                + ((i % n) * edge + j % n) * edge + k % n, edge, a - i,
+                b - j, c - k);
+        return std::isnan(rho) ? model.density(inputs) : rho;
+    }
+
+    const Atmosphere &base() const { return model; }
+
+private:
+    int alt_cells() const {
+        return static_cast<int>(std::ceil(
+                (grid.alt_max - grid.alt_min) / grid.alt_step));
+    }
+    int lat_cells() const {
+        return static_cast<int>(std::ceil(180.0 / grid.lat_step));
+    }
+    int local_time_cells() const {
+        return static_cast<int>(std::ceil(24.0 / grid.local_time_step));
+    }
+
+    Density_tile build(const Msis_inputs &inputs, int bucket,
+            const Density_tile_key &key) const {
+        // Nodes on the upper edges are shared with the next tile and are
+        // ...evaluated by both, so any cell is interpolated from one tile
+        int n = grid.tile_cells;
+        int edge = n + 1;
+        Density_tile tile;
+        Msis_inputs node = inputs;
+        node.second = std::min((bucket + 0.5) * grid.bucket_seconds,
+                86399.0);
+        if (store != nullptr && store->load(grid, key, node, tile)) {
+            return tile;
+        }
+        tile.assign(edge * edge * edge, std::nan(""));
+        for (int i = 0; i < edge; ++i) {
+            node.alt = grid.alt_min + (key.alt_band * n + i) * grid.alt_step;
+            for (int j = 0; j < edge; ++j) {
+                node.lat = std::min(-90.0 + (key.lat_band * n + j)
+                        * grid.lat_step, 90.0);
+                for (int k = 0; k < edge; ++k) {
+                    double local_time = (key.local_time_band * n + k)
+                            * grid.local_time_step;
+                    node.lon = std::remainder(
+                            (local_time - node.second / 3600.0) * 15.0,
+                            360.0);
+                    double rho = model.density(node);
+                    tile[(i * edge + j) * edge + k] = rho > 0.0
+                            ? std::log(rho) : std::nan("");
+                }
+            }
+        }
+        if (store != nullptr) {
+            store->save(grid, key, node, tile);
+        }
+        return tile;
+    }
+
+    Atmosphere model;
+    std::shared_ptr<Density_tile_cache> cache;
+    Density_tile_grid grid;
+    std::shared_ptr<Density_tile_store> store;
+};
+
+#endif
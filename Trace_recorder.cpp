@@ -0,0 +1,117 @@
+/*! @file Trace_recorder.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Span tracing into per-thread ring buffers, written as Chrome trace
+ */
+
+#include "Trace_recorder.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Trace_event {
+    const char *name;
+    std::uint64_t start_ns;
+    std::uint64_t end_ns;
+};
+
+// Fixed size ring, the oldest spans are overwritten once it is full
+struct Trace_buffer {
+    std::vector<Trace_event> events;
+    std::size_t next = 0;
+    bool wrapped = false;
+    int tid = 0;
+};
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<Trace_buffer>> buffers;
+std::string trace_path;
+std::size_t buffer_capacity = 0;
+std::uint64_t origin_ns = 0;
+std::atomic<std::uint64_t> generation(0);
+
+Trace_buffer &local_buffer() {
+    // A thread registers its buffer on its first span of each trace
+    thread_local std::uint64_t local_generation = 0;
+    thread_local Trace_buffer *local = nullptr;
+    std::uint64_t current = generation.load(std::memory_order_acquire);
+    if (local == nullptr || local_generation != current) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffers.push_back(std::make_unique<Trace_buffer>());
+        local = buffers.back().get();
+        local->events.resize(buffer_capacity);
+        local->tid = static_cast<int>(buffers.size());
+        local_generation = current;
+    }
+    return *local;
+}
+
+}
+
+std::atomic<bool> Trace_recorder::active(false);
+
+
+std::uint64_t Trace_recorder::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void Trace_recorder::start(const std::string &path, 
+        std::size_t events_per_thread) {
+    // Drops anything recorded before and begins a new trace
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffers.clear();
+    trace_path = path;
+    buffer_capacity = events_per_thread > 0 ? events_per_thread : 1;
+    origin_ns = now_ns();
+    generation.fetch_add(1, std::memory_order_release);
+    active.store(true, std::memory_order_relaxed);
+}
+
+
+void Trace_recorder::record(const char *name, std::uint64_t start_ns, 
+        std::uint64_t end_ns) {
+    Trace_buffer &buffer = local_buffer();
+    buffer.events[buffer.next] = {name, start_ns, end_ns};
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+
+bool Trace_recorder::flush() {
+    // Stops tracing and writes every thread's spans, oldest first
+    active.store(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    FILE *file = std::fopen(trace_path.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto &buffer : buffers) {
+        std::size_t count = buffer->wrapped ? buffer->events.size() 
+                : buffer->next;
+        std::size_t begin = buffer->wrapped ? buffer->next : 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const Trace_event &event 
+                    = buffer->events[(begin + i) % buffer->events.size()];
+            std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"drag\","
+                    "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                    "\"tid\":%d}", first ? "" : ",\n", event.name, 
+                    (event.start_ns - origin_ns) / 1000.0, 
+                    (event.end_ns - event.start_ns) / 1000.0, buffer->tid);
+            first = false;
+        }
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    buffers.clear();
+    generation.fetch_add(1, std::memory_order_release);
+    return std::fclose(file) == 0;
+}
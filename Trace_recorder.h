@@ -0,0 +1,59 @@
+/*! @file Trace_recorder.h
+	@author John Keeling
+	@date 16 October 2026
+	@brief Span tracing into per-thread ring buffers, written as Chrome trace
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Collects spans while enabled and writes them as Chrome trace JSON, which 
+// ...opens in chrome://tracing or Perfetto. start() and flush() are meant 
+// ...for the beginning and end of a run, when no span is open on any thread.
+class Trace_recorder {
+public:
+    static void start(const std::string &path, 
+            std::size_t events_per_thread = 65536);
+    static bool flush();
+
+    static bool enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+    static std::uint64_t now_ns();
+    static void record(const char *name, std::uint64_t start_ns, 
+            std::uint64_t end_ns);
+
+private:
+    static std::atomic<bool> active;
+};
+
+// Records the time from construction to end() or destruction as one span. 
+// ...name must be a string literal, only the pointer is kept.
+class Trace_span {
+public:
+    explicit Trace_span(const char *in_name) 
+            : name(in_name), open(Trace_recorder::enabled()),
+            start_ns(open ? Trace_recorder::now_ns() : 0) {}
+    ~Trace_span() { end(); }
+    Trace_span(const Trace_span &) = delete;
+    Trace_span &operator=(const Trace_span &) = delete;
+
+    void end() {
+        if (open) {
+            Trace_recorder::record(name, start_ns, Trace_recorder::now_ns());
+            open = false;
+        }
+    }
+
+private:
+    const char *name;
+    bool open;
+    std::uint64_t start_ns;
+};
+
+#endif
@@ -0,0 +1,218 @@
+/*! @file drag_benchmark.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Times each stage of the nrlmsise00 drag density pipeline
+ */
+
+#include "../include/Resident_space_object.h"
+#include "../include/Resident_variables.h"
+#include "Msis_inputs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Benchmark_result {
+    std::string name;
+    std::size_t iterations;
+    double ns_per_op;
+    double cpu_ns_per_op;
+};
+
+// Keeps results live so the timed calls are not optimised away
+volatile double benchmark_sink = 0.0;
+
+template <typename Stage>
+Benchmark_result time_stage(const char *name, std::size_t iterations,
+        Stage &&stage) {
+    double sum = 0.0;
+    std::clock_t cpu_start = std::clock();
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sum += stage(i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+    // Process CPU time, so it leaves out the model process for those stages
+    double cpu_ns = double(std::clock() - cpu_start) * 1e9 / CLOCKS_PER_SEC;
+    benchmark_sink = benchmark_sink + sum;
+    return {name, iterations, ns / iterations, cpu_ns / iterations};
+}
+
+bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Synthetic SOLFSMY.TXT and apindex with constant indices for every day
+// ...of 2000 to 2099, in the columns load_f107_table and load_ap_table
+// ...read, so the benchmark needs no data files and always finds its date
+bool write_synthetic_indices(const std::string &f107_path,
+        const std::string &ap_path) {
+    std::FILE *f107 = std::fopen(f107_path.c_str(), "w");
+    std::FILE *ap = std::fopen(ap_path.c_str(), "w");
+    if (f107 == NULL || ap == NULL) {
+        if (f107 != NULL) {
+            std::fclose(f107);
+        }
+        if (ap != NULL) {
+            std::fclose(ap);
+        }
+        return false;
+    }
+    static const int month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30,
+            31, 30, 31};
+    double julian_date = 2451544.5;
+    std::fprintf(f107, "# Synthetic F10.7, drag_benchmark\n");
+    for (int year = 2000; year < 2100; ++year) {
+        int day_of_year = 0;
+        for (int month = 1; month <= 12; ++month) {
+            int length = month_days[month - 1]
+                    + (month == 2 && is_leap_year(year) ? 1 : 0);
+            for (int day = 1; day <= length; ++day) {
+                std::fprintf(f107, "%d %3d %.1f 150.0 150.0\n", year,
+                        ++day_of_year, julian_date);
+                julian_date += 1.0;
+                std::fprintf(ap, "%02d%02d%02d%25s", year % 100, month, day,
+                        "");
+                for (int i = 0; i < 8; ++i) {
+                    std::fprintf(ap, "%3d", 4);
+                }
+                std::fprintf(ap, "\n");
+            }
+        }
+    }
+    std::fclose(f107);
+    std::fclose(ap);
+    return true;
+}
+
+void write_json(std::ostream &out,
+        const std::vector<Benchmark_result> &results) {
+    // The benchmark fields of Google Benchmark's JSON, with real and CPU
+    // ...time, so its compare.py can compare two runs
+    out << "{\n  \"context\": {\n    \"executable\": \"drag_benchmark\"\n"
+            << "  },\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        out << "    {\"name\": \"" << results[i].name
+                << "\", \"run_type\": \"iteration\", \"iterations\": "
+                << results[i].iterations << ", \"real_time\": "
+                << results[i].ns_per_op << ", \"cpu_time\": "
+                << results[i].cpu_ns_per_op << ", \"time_unit\": \"ns\"}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+// Usage: drag_benchmark [iterations [json file]]
+// ...Times every stage of nrlmsise00_density and compute_acceleration on a
+// ...synthetic state, with synthetic index files. The model stages run
+// ...the executable in OPS_MSIS_MODEL_DIR and take iterations / 1000
+// ...calls. Results are printed, and written as JSON to the file if given.
+int main(int argc, char *argv[]) {
+    std::size_t iterations = argc > 1 ? std::strtoul(argv[1], NULL, 10)
+            : 100000;
+    std::size_t model_iterations = std::max<std::size_t>(iterations / 1000,
+            10);
+
+    // Index locations are read on first use, so they are set before that
+    char directory[] = "/tmp/drag_benchmark_XXXXXX";
+    if (mkdtemp(directory) == NULL) {
+        std::cerr << "Unable to make a directory for index files"
+                << std::endl;
+        return 1;
+    }
+    std::string f107_path = std::string(directory) + "/SOLFSMY.TXT";
+    std::string ap_path = std::string(directory) + "/apindex";
+    if (!write_synthetic_indices(f107_path, ap_path)) {
+        std::cerr << "Unable to write index files in " << directory
+                << std::endl;
+        return 1;
+    }
+    setenv("OPS_MSIS_F107_FILE", f107_path.c_str(), 1);
+    setenv("OPS_MSIS_AP_FILE", ap_path.c_str(), 1);
+
+    // Synthetic state, a 400 km orbit
+    Resident_constants rso_const;
+    auto state = std::make_shared<Resident_variables>();
+    state->geodetic.alt = 400.0;
+    state->geodetic.lat = 51.6;
+    state->geodetic.lon = -0.1;
+    state->ecef_v = 7.66;
+    Force_drag_nrlmsise00 drag;
+    drag.setup(rso_const, state);
+
+    std::string epoch = state->eci.epoch.str_UTC_datestamp();
+    auto [day_of_year, previous_day, f10_year, second, day, month, year]
+            = Force_drag_nrlmsise00::msis_time_stamp(epoch);
+    Msis_inputs inputs = Force_drag_nrlmsise00::msis_inputs(epoch,
+            state->geodetic.alt, state->geodetic.lat, state->geodetic.lon);
+
+    std::vector<Benchmark_result> results;
+    results.push_back(time_stage("msis_lla_coordinates", iterations,
+            [](std::size_t i) {
+                auto [alt, lat, lon] = Force_drag_nrlmsise00::
+                        msis_lla_coordinates(400.0 + i * 1e-6, 51.6, -0.1);
+                return alt + lat + lon;
+            }));
+    results.push_back(time_stage("msis_time_stamp", iterations,
+            [&epoch](std::size_t) {
+                return double(std::get<0>(
+                        Force_drag_nrlmsise00::msis_time_stamp(epoch)));
+            }));
+    results.push_back(time_stage("leap_year_doy", iterations,
+            [&](std::size_t i) {
+                return double(std::get<0>(Force_drag_nrlmsise00::
+                        leap_year_doy(year + int(i % 4), month, day)));
+            }));
+    results.push_back(time_stage("msis_f107", iterations,
+            [&](std::size_t) {
+                return std::get<0>(Force_drag_nrlmsise00::msis_f107(
+                        previous_day, f10_year));
+            }));
+    results.push_back(time_stage("ap_value", iterations,
+            [&](std::size_t) {
+                return Force_drag_nrlmsise00::ap_value(year, month, day);
+            }));
+    results.push_back(time_stage("retrieve_mass_density", model_iterations,
+            [&](std::size_t) {
+                return drag.retrieve_mass_density(inputs);
+            }));
+    results.push_back(time_stage("compute_acceleration/msis",
+            model_iterations, [&](std::size_t) {
+                drag.compute_acceleration();
+                return state->atmos_density;
+            }));
+    state->geodetic.alt = 1500.0;
+    results.push_back(time_stage("compute_acceleration/exponential",
+            iterations, [&](std::size_t) {
+                drag.compute_acceleration();
+                return state->atmos_density;
+            }));
+
+    for (const Benchmark_result &result : results) {
+        std::printf("%-36s %10zu %14.1f ns\n", result.name.c_str(),
+                result.iterations, result.ns_per_op);
+    }
+    if (argc > 2) {
+        std::ofstream json(argv[2]);
+        write_json(json, results);
+        if (!json) {
+            std::cerr << "Unable to write " << argv[2] << std::endl;
+        }
+    }
+    std::remove(f107_path.c_str());
+    std::remove(ap_path.c_str());
+    rmdir(directory);
+    return 0;
+}
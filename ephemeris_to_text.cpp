@@ -0,0 +1,54 @@
+/*! @file ephemeris_to_text.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Converts a columnar binary ephemeris to the text ephemeris format
+ */
+
+#include "Ephemeris_columnar.h"
+#include "Ephemeris_writer.h"
+#include <cstdlib>
+#include <iostream>
+
+// Usage: ephemeris_to_text <columnar file> <text file> [start end]
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 5) {
+        std::cerr << "Usage: ephemeris_to_text <columnar file> <text file> "
+                "[start end]" << std::endl;
+        return 1;
+    }
+    Columnar_ephemeris_reader reader(argv[1]);
+    if (!reader.good()) {
+        std::cerr << "Unable to read " << argv[1] << std::endl;
+        return 1;
+    }
+    Ephemeris_writer writer(argv[2]);
+    if (!writer.good()) {
+        std::cerr << "Unable to open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::vector<Ephemeris_record> records;
+    if (argc == 5) {
+        if (!reader.read_range(std::atof(argv[3]), std::atof(argv[4]), 
+                records)) {
+            std::cerr << "Corrupt block in " << argv[1] << std::endl;
+            return 1;
+        }
+        for (const Ephemeris_record &record : records) {
+            writer.append(record);
+        }
+        return 0;
+    }
+    for (std::size_t block = 0; block < reader.blocks().size(); ++block) {
+        records.clear();
+        if (!reader.read_block(block, records)) {
+            std::cerr << "Corrupt block " << block << " in " << argv[1] 
+                    << std::endl;
+            return 1;
+        }
+        for (const Ephemeris_record &record : records) {
+            writer.append(record);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*! @file msis_replay.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Replays a density capture log through a density backend
+ */
+
+#include "Atmosphere_models.h"
+#include "Density_capture.h"
+#include "Density_pipeline.h"
+#include "Nrlmsise00_model.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+// Usage: msis_replay <capture log> [backend [source [workers [batch]]]]
+// ...backend is nrlmsise00, the default, with source its model directory,
+// ...or exponential, ussa76, or tabulated with source its table file.
+// ...Every record is evaluated once, then throughput and the largest 
+// ...relative difference from the captured density are reported. Given a
+// ...number of workers, the records are then also sent through a 
+// ...Density_pipeline in batches, and its throughput compared.
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: msis_replay <capture log> [backend [source "
+                "[workers [batch]]]]" << std::endl;
+        return 1;
+    }
+    std::string backend = argc > 2 ? argv[2] : "nrlmsise00";
+    bool nrlmsise00 = backend == "nrlmsise00";
+    std::string source = argc > 3 ? argv[3] 
+            : nrlmsise00 ? nrlmsise00_model_dir() : std::string();
+    std::optional<Runtime_atmosphere> atmosphere = make_atmosphere(backend,
+            source);
+    if (!atmosphere && backend == "tabulated") {
+        std::cerr << "Unable to read a density table from " << source 
+                << std::endl;
+        return 1;
+    }
+    if (!atmosphere) {
+        std::cerr << "Unknown backend " << backend << std::endl;
+        return 1;
+    }
+    // NRLMSISE-00 is run from source, the other models through the policy
+    auto density = [&](const Msis_inputs &inputs) {
+        return nrlmsise00 ? nrlmsise00_run(inputs, source) 
+                : atmosphere->density(inputs);
+    };
+
+    std::vector<Density_record> records;
+    if (!read_density_capture(argv[1], records)) {
+        std::cerr << "Unable to read capture log " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Results are kept so the timed loop does nothing but evaluate
+    std::vector<double> rho(records.size());
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        rho[i] = density(records[i].inputs);
+    }
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    double max_rel = 0.0;
+    std::size_t worst = 0;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        double rel = std::fabs(rho[i] - records[i].rho) 
+                / std::fabs(records[i].rho);
+        if (rel > max_rel) {
+            max_rel = rel;
+            worst = i;
+        }
+    }
+
+    std::cout << records.size() << " records through " << backend << " in " 
+            << seconds << " s (" << records.size() / seconds 
+            << " evaluations/s)" << std::endl;
+    std::cout << "Max relative difference from capture: " << max_rel;
+    if (!records.empty()) {
+        std::cout << " at record " << worst;
+    }
+    std::cout << std::endl;
+
+    if (argc > 4) {
+        // One channel per worker, all fed from this thread round robin
+        int worker_count = std::max(std::atoi(argv[4]), 1);
+        std::size_t batch = argc > 5 ? std::max(std::atoi(argv[5]), 1) : 16;
+        std::vector<Density_completion> completions(records.size());
+        auto pipeline_start = std::chrono::steady_clock::now();
+        {
+            Density_pipeline pipeline([&](const Msis_inputs *inputs,
+                    std::size_t count, double *results) {
+                        if (nrlmsise00) {
+                            nrlmsise00_run_batch(inputs, count, results, 
+                                    source);
+                            return;
+                        }
+                        for (std::size_t i = 0; i < count; ++i) {
+                            results[i] = density(inputs[i]);
+                        }
+                    }, worker_count, batch);
+            std::vector<Density_channel *> channels;
+            for (int i = 0; i < worker_count; ++i) {
+                channels.push_back(pipeline.connect());
+            }
+            for (std::size_t i = 0; i < records.size(); ++i) {
+                channels[i % channels.size()]->submit(records[i].inputs, 
+                        completions[i]);
+            }
+            for (Density_completion &completion : completions) {
+                completion.wait();
+            }
+        }
+        double pipeline_seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - pipeline_start).count();
+        std::size_t differing = 0;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            differing += completions[i].wait() != rho[i] ? 1 : 0;
+        }
+        std::cout << "Pipeline, " << worker_count << " workers, batches of "
+                << batch << ": " << pipeline_seconds << " s (" 
+                << records.size() / pipeline_seconds << " evaluations/s, " 
+                << seconds / pipeline_seconds << "x synchronous), " 
+                << differing << " results differ" << std::endl;
+    }
+    return 0;
+}
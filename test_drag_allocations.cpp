@@ -0,0 +1,236 @@
+/*! @file test_drag_allocations.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fails if compute_acceleration in the exponential tier, or the
+	density input stages, allocate in steady state
+ */
+
+#include "../include/Resident_space_object.h"
+#include "../include/Resident_variables.h"
+#include "Msis_inputs.h"
+#include "Nrlmsise00_model.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// Counted only between start and stop, so setup and reporting may allocate
+std::atomic<bool> counting{false};
+std::atomic<unsigned long> allocations{0};
+
+void *counted_allocation(std::size_t size) {
+#if !defined(__GLIBC__)
+    // Under glibc the malloc below is counted instead
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+    void *memory = std::malloc(size != 0 ? size : 1);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+}
+
+void *operator new(std::size_t size) {
+    return counted_allocation(size);
+}
+
+void *operator new[](std::size_t size) {
+    return counted_allocation(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+#if defined(__GLIBC__)
+// C allocations too, e.g. from stdio, through glibc's own entry points
+extern "C" void *__libc_malloc(std::size_t size);
+extern "C" void *__libc_calloc(std::size_t count, std::size_t size);
+extern "C" void *__libc_realloc(void *memory, std::size_t size);
+
+extern "C" void *malloc(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(std::size_t count, std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *memory, std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(memory, size);
+}
+#endif
+
+namespace {
+
+bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Index files with a constant entry for every day of the epoch's year and
+// ...the one before, in the columns load_f107_table and load_ap_table read
+bool write_indices(int epoch_year, const std::string &f107_path,
+        const std::string &ap_path) {
+    std::FILE *f107 = std::fopen(f107_path.c_str(), "w");
+    std::FILE *ap = std::fopen(ap_path.c_str(), "w");
+    if (f107 == NULL || ap == NULL) {
+        if (f107 != NULL) {
+            std::fclose(f107);
+        }
+        if (ap != NULL) {
+            std::fclose(ap);
+        }
+        return false;
+    }
+    static const int month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30,
+            31, 30, 31};
+    for (int year = epoch_year - 1; year <= epoch_year; ++year) {
+        int day_of_year = 0;
+        for (int month = 1; month <= 12; ++month) {
+            int length = month_days[month - 1]
+                    + (month == 2 && is_leap_year(year) ? 1 : 0);
+            for (int day = 1; day <= length; ++day) {
+                std::fprintf(f107, "%d %3d 0.0 150.0 150.0\n", year,
+                        ++day_of_year);
+                std::fprintf(ap, "%02d%02d%02d%25s", year % 100, month, day,
+                        "");
+                for (int i = 0; i < 8; ++i) {
+                    std::fprintf(ap, "%3d", 4);
+                }
+                std::fprintf(ap, "\n");
+            }
+        }
+    }
+    std::fclose(f107);
+    std::fclose(ap);
+    return true;
+}
+
+// One step of every stage of nrlmsise00_density up to the model process,
+// ...and the model's command line
+double drive_stages(const std::string &epoch, int step, char *cmd,
+        std::size_t size) {
+    auto [alt, lat, lon] = Force_drag_nrlmsise00::msis_lla_coordinates(
+            400.0 + step * 1e-3, 51.6, -0.1 + step * 1e-3);
+    auto [time_day_of_year, time_previous_day, time_f10_year, second, day,
+            month, year] = Force_drag_nrlmsise00::msis_time_stamp(epoch);
+    auto [day_of_year, previous_day, f10_year]
+            = Force_drag_nrlmsise00::leap_year_doy(year, month, day);
+    auto [f107, f107a] = Force_drag_nrlmsise00::msis_f107(previous_day,
+            f10_year);
+    Msis_inputs inputs;
+    inputs.year = year;
+    inputs.day_of_year = day_of_year;
+    inputs.second = second;
+    inputs.alt = alt;
+    inputs.lat = lat;
+    inputs.lon = lon;
+    inputs.f107 = f107;
+    inputs.f107a = f107a;
+    inputs.ap = Force_drag_nrlmsise00::ap_value(year, month, day);
+    if (!nrlmsise00_command(inputs, nrlmsise00_model_dir(), cmd, size)) {
+        return 0.0;
+    }
+    return inputs.f107 + inputs.ap + cmd[0];
+}
+
+}
+
+// Usage: test_drag_allocations [steps]
+// ...Runs the density input stages, the model command line and
+// ...compute_acceleration in the exponential tier for the given number of
+// ...steps after one warm-up step, and fails if any of them allocates.
+// ...The datestamp string is made once, as Epoch::str_UTC_datestamp()
+// ...allocates outside this code, and the model process is not started.
+int main(int argc, char *argv[]) {
+    int steps = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 10000;
+
+    Resident_constants rso_const;
+    auto state = std::make_shared<Resident_variables>();
+    state->geodetic.alt = 1500.0;
+    state->geodetic.lat = 51.6;
+    state->geodetic.lon = -0.1;
+    state->ecef_v = 7.66;
+    std::string epoch = state->eci.epoch.str_UTC_datestamp();
+
+    // Index locations are read on first use, so they are set before setup
+    char directory[] = "/tmp/test_drag_allocations_XXXXXX";
+    if (mkdtemp(directory) == NULL) {
+        std::cerr << "Unable to make a directory for index files"
+                << std::endl;
+        return 1;
+    }
+    std::string f107_path = std::string(directory) + "/SOLFSMY.TXT";
+    std::string ap_path = std::string(directory) + "/apindex";
+    int epoch_year = std::get<6>(Force_drag_nrlmsise00::msis_time_stamp(
+            epoch));
+    if (!write_indices(epoch_year, f107_path, ap_path)) {
+        std::cerr << "Unable to write index files in " << directory
+                << std::endl;
+        return 1;
+    }
+    setenv("OPS_MSIS_F107_FILE", f107_path.c_str(), 1);
+    setenv("OPS_MSIS_AP_FILE", ap_path.c_str(), 1);
+
+    Force_drag_nrlmsise00 drag;
+    drag.setup(rso_const, state);
+
+    // Warm-up, for first-use statics and per-thread recorders
+    char cmd[1024];
+    double sink = drive_stages(epoch, 0, cmd, sizeof(cmd));
+    drag.compute_acceleration();
+
+    counting.store(true);
+    for (int step = 1; step <= steps; ++step) {
+        sink += drive_stages(epoch, step, cmd, sizeof(cmd));
+        drag.compute_acceleration();
+        sink += state->atmos_density;
+    }
+    counting.store(false);
+
+    std::remove(f107_path.c_str());
+    std::remove(ap_path.c_str());
+    rmdir(directory);
+
+    unsigned long count = allocations.load();
+    std::cout << steps << " steps, " << count << " allocations (checksum "
+            << sink << ")" << std::endl;
+    if (count != 0) {
+        std::cerr << "FAILED: the density stages allocated in steady state"
+                << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*! @file test_orbit_average_drag.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fails if Orbit_average_drag departs from a step-by-step integration
+	of the same orbit and atmosphere
+ */
+
+#include "Atmosphere_models.h"
+#include "Orbit_average_drag.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+const double mu = 398600.4418;          // km3/s2
+const double earth_radius = 6378.137;   // km
+
+struct Cartesian {
+    double r[3];    // km
+    double v[3];    // km/s
+};
+
+// Two-body plus drag in a non-rotating exponential atmosphere on a
+// ...spherical Earth, the assumptions Orbit_average_drag makes
+Cartesian derivative(const Cartesian &state, double ballistic) {
+    double radius = std::sqrt(state.r[0] * state.r[0]
+            + state.r[1] * state.r[1] + state.r[2] * state.r[2]);
+    double speed = std::sqrt(state.v[0] * state.v[0]
+            + state.v[1] * state.v[1] + state.v[2] * state.v[2]);
+    double rho = Exponential_atmosphere::altitude_density(
+            radius - earth_radius);
+    // B rho v^2 / 2 is in m/s2 with v in m/s, hence 1e6 / 1e3 for km
+    double drag = -0.5 * ballistic * rho * speed * 1000.0;
+    double gravity = -mu / (radius * radius * radius);
+    Cartesian result;
+    for (int k = 0; k < 3; ++k) {
+        result.r[k] = state.v[k];
+        result.v[k] = gravity * state.r[k] + drag * state.v[k];
+    }
+    return result;
+}
+
+Cartesian add(const Cartesian &state, const Cartesian &rate, double dt) {
+    Cartesian result;
+    for (int k = 0; k < 3; ++k) {
+        result.r[k] = state.r[k] + rate.r[k] * dt;
+        result.v[k] = state.v[k] + rate.v[k] * dt;
+    }
+    return result;
+}
+
+Cartesian rk4_step(const Cartesian &state, double ballistic, double dt) {
+    Cartesian k1 = derivative(state, ballistic);
+    Cartesian k2 = derivative(add(state, k1, 0.5 * dt), ballistic);
+    Cartesian k3 = derivative(add(state, k2, 0.5 * dt), ballistic);
+    Cartesian k4 = derivative(add(state, k3, dt), ballistic);
+    Cartesian result = state;
+    for (int k = 0; k < 3; ++k) {
+        result.r[k] += dt / 6.0 * (k1.r[k] + 2.0 * k2.r[k] + 2.0 * k3.r[k]
+                + k4.r[k]);
+        result.v[k] += dt / 6.0 * (k1.v[k] + 2.0 * k2.v[k] + 2.0 * k3.v[k]
+                + k4.v[k]);
+    }
+    return result;
+}
+
+// Osculating semi-major axis and eccentricity
+void osculating(const Cartesian &state, double &a, double &e) {
+    double radius = std::sqrt(state.r[0] * state.r[0]
+            + state.r[1] * state.r[1] + state.r[2] * state.r[2]);
+    double speed2 = state.v[0] * state.v[0] + state.v[1] * state.v[1]
+            + state.v[2] * state.v[2];
+    a = 1.0 / (2.0 / radius - speed2 / mu);
+    double h[3] = {state.r[1] * state.v[2] - state.r[2] * state.v[1],
+            state.r[2] * state.v[0] - state.r[0] * state.v[2],
+            state.r[0] * state.v[1] - state.r[1] * state.v[0]};
+    double h2 = h[0] * h[0] + h[1] * h[1] + h[2] * h[2];
+    e = std::sqrt(std::max(0.0, 1.0 - h2 / (mu * a)));
+}
+
+}
+
+// Usage: test_orbit_average_drag [days]
+// ...Propagates a 350 km perigee, e = 0.01 orbit with B = 0.01 m2/kg in
+// ...the exponential atmosphere, by Orbit_average_drag one revolution per
+// ...step and by RK4 at 10 s steps, and fails if the decay in a differs
+// ...by more than 1% or the final e by more than 5e-6.
+int main(int argc, char *argv[]) {
+    double days = argc > 1 ? std::max(std::atof(argv[1]), 1.0) : 20.0;
+    const double ballistic = 0.01;
+    const double duration = days * 86400.0;
+
+    Mean_elements elements;
+    elements.e = 0.01;
+    elements.a = (earth_radius + 350.0) / (1.0 - elements.e);
+    elements.i = 51.6 * M_PI / 180.0;
+    elements.year = 2020;
+    elements.day_of_year = 1;
+
+    // Starts at perigee in the orbit plane, which is the xy plane as the
+    // ...atmosphere is spherically symmetric
+    double perigee = elements.a * (1.0 - elements.e);
+    Cartesian state = {{perigee, 0.0, 0.0}, {0.0, std::sqrt(mu
+            * (1.0 + elements.e) / perigee), 0.0}};
+    const double dt = 10.0;
+    for (double t = 0.0; t < duration; t += dt) {
+        state = rk4_step(state, ballistic, std::min(dt, duration - t));
+    }
+    double rk4_a, rk4_e;
+    osculating(state, rk4_a, rk4_e);
+
+    Orbit_average_drag<Exponential_atmosphere> average(
+            Exponential_atmosphere(), ballistic);
+    Mean_elements mean = elements;
+    double elapsed = 0.0;
+    while (elapsed < duration) {
+        double revolutions = std::min(1.0,
+                (duration - elapsed) / orbit_period(mean));
+        elapsed += revolutions * orbit_period(mean);
+        mean = average.step(mean, revolutions);
+    }
+
+    double rk4_decay = elements.a - rk4_a;
+    double average_decay = elements.a - mean.a;
+    std::cout << days << " days: RK4 decay " << rk4_decay << " km, e "
+            << rk4_e << "; orbit-averaged decay " << average_decay
+            << " km, e " << mean.e << std::endl;
+    bool failed = false;
+    if (std::fabs(average_decay - rk4_decay) > 0.01 * std::fabs(rk4_decay)) {
+        std::cerr << "FAILED: the decay in a differs by more than 1%"
+                << std::endl;
+        failed = true;
+    }
+    if (std::fabs(mean.e - rk4_e) > 5e-6) {
+        std::cerr << "FAILED: the final e differs by more than 5e-6"
+                << std::endl;
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/*! @file test_pipeline_fairness.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fails if a busy channel keeps a Density_pipeline worker from
+	another channel on the same worker
+ */
+
+#include "Density_pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Usage: test_pipeline_fairness [requests [bound ms]]
+// ...One worker, batches of 4, serves two channels. A flooding thread
+// ...keeps the first channel's ring full while the quiet second channel
+// ...submits the given number of requests one at a time. Fails if any of
+// ...those waits longer than the bound. A quiet request still waiting
+// ...after 5 s stops the flood, so a starved run ends and fails.
+int main(int argc, char *argv[]) {
+    int requests = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 200;
+    double bound_ms = argc > 2 ? std::atof(argv[2]) : 100.0;
+    const std::size_t ring_capacity = 256;
+    using Clock = std::chrono::steady_clock;
+
+    // Completions outlive the pipeline, whose destructor drains the rings
+    std::vector<Density_completion> flood_completions(2 * ring_capacity);
+    Density_completion quiet_completion;
+    std::atomic<bool> flooding{true};
+    std::uint64_t flood_count = 0;
+    double worst_ms = 0.0;
+    {
+        Density_pipeline pipeline([](const Msis_inputs *, std::size_t count,
+                double *rho) {
+            std::fill(rho, rho + count, 1.0);
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }, 1, 4, ring_capacity);
+        Density_channel *busy = pipeline.connect();
+        Density_channel *quiet = pipeline.connect();
+
+        std::thread flood([&]() {
+            // More completions than ring slots, so the ring stays full;
+            // ...each is reused only once its last request is back
+            std::size_t slots = flood_completions.size();
+            while (flooding.load(std::memory_order_relaxed)) {
+                Density_completion &completion
+                        = flood_completions[flood_count % slots];
+                if (flood_count >= slots) {
+                    completion.wait();
+                }
+                busy->submit(Msis_inputs(), completion);
+                ++flood_count;
+            }
+        });
+
+        Clock::time_point flood_limit = Clock::now()
+                + std::chrono::seconds(5);
+        for (int n = 0; n < requests; ++n) {
+            Clock::time_point start = Clock::now();
+            quiet->submit(Msis_inputs(), quiet_completion);
+            while (!quiet_completion.ready()) {
+                if (Clock::now() > flood_limit) {
+                    flooding.store(false, std::memory_order_relaxed);
+                }
+                std::this_thread::yield();
+            }
+            worst_ms = std::max(worst_ms, std::chrono::duration<double,
+                    std::milli>(Clock::now() - start).count());
+        }
+        flooding.store(false, std::memory_order_relaxed);
+        flood.join();
+    }
+
+    std::cout << requests << " quiet requests beside " << flood_count
+            << " flooding ones, worst wait " << worst_ms << " ms"
+            << std::endl;
+    if (worst_ms > bound_ms) {
+        std::cerr << "FAILED: a quiet request waited longer than "
+                << bound_ms << " ms" << std::endl;
+        return 1;
+    }
+    return 0;
+}
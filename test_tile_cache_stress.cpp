@@ -0,0 +1,103 @@
+/*! @file test_tile_cache_stress.cpp
+	@author John Keeling
+	@date 16 October 2026
+	@brief Fails if Density_tile_cache exceeds its byte limit or returns the
+	wrong tile under concurrent random lookups
+ */
+
+#include "Density_tile_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Value every node of the tile for key is built with, so a tile handed
+// ...back for the wrong key is detected
+double key_value(const Density_tile_key &key) {
+    return static_cast<double>(key.epoch_bucket) * 1e6 + key.alt_band * 1e4
+            + key.lat_band * 1e2 + key.local_time_band;
+}
+
+}
+
+// Usage: test_tile_cache_stress [threads [lookups per thread]]
+// ...Each thread looks up random keys from a space far larger than the
+// ...1 MiB cache, with tiles of varying size, and checks every tile's
+// ...contents. The cache's bytes are sampled throughout. Run under
+// ...ThreadSanitizer to check the locking as well.
+int main(int argc, char *argv[]) {
+    int thread_count = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 8;
+    long lookups = argc > 2 ? std::max(std::atol(argv[2]), 1L) : 200000;
+    const std::size_t limit = 1 << 20;
+
+    Density_tile_cache cache(limit, 16);
+    std::atomic<std::size_t> peak{0};
+    std::atomic<long> wrong{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            std::uint32_t seed = 7919u * static_cast<std::uint32_t>(t) + 1u;
+            for (long n = 0; n < lookups; ++n) {
+                seed = seed * 1103515245u + 12345u;
+                // Skewed towards a hot set, so hits and evictions both occur
+                std::uint32_t spread = (seed >> 28) < 12 ? 64 : 65536;
+                std::uint32_t draw = (seed >> 4) % spread;
+                Density_tile_key key = {static_cast<std::int64_t>(draw / 512),
+                        static_cast<int>(draw % 8),
+                        static_cast<int>((draw / 8) % 8),
+                        static_cast<int>((draw / 64) % 8)};
+                std::size_t nodes = 64 + (draw % 4) * 61;
+                auto tile = cache.find_or_build(key, [&key, nodes]() {
+                    return Density_tile(nodes, key_value(key));
+                });
+                if (tile->empty() || (*tile)[0] != key_value(key)
+                        || tile->back() != key_value(key)) {
+                    wrong.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (n % 256 == 0) {
+                    std::size_t bytes = cache.stats().bytes;
+                    std::size_t seen = peak.load(std::memory_order_relaxed);
+                    while (bytes > seen && !peak.compare_exchange_weak(seen,
+                            bytes, std::memory_order_relaxed)) {}
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    Density_tile_cache_stats stats = cache.stats();
+    std::size_t highest = std::max(peak.load(), stats.bytes);
+    std::cout << thread_count << " threads, " << stats.hits << " hits, "
+            << stats.misses << " misses, " << stats.evictions
+            << " evictions, peak " << highest << " of " << limit
+            << " bytes" << std::endl;
+    bool failed = false;
+    if (highest > limit) {
+        std::cerr << "FAILED: cache held more than its limit" << std::endl;
+        failed = true;
+    }
+    if (wrong.load() != 0) {
+        std::cerr << "FAILED: " << wrong.load()
+                << " lookups returned another key's tile" << std::endl;
+        failed = true;
+    }
+    if (stats.hits + stats.misses
+            != static_cast<std::uint64_t>(thread_count) * lookups) {
+        std::cerr << "FAILED: hits and misses do not add up to lookups"
+                << std::endl;
+        failed = true;
+    }
+    if (stats.hits == 0 || stats.evictions == 0) {
+        std::cerr << "FAILED: the run did not exercise both hits and"
+                " eviction" << std::endl;
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}